@@ -2,15 +2,22 @@
 // Proximity Alert System Implementation
 
 #include <Arduino.h>
+#include <util/atomic.h>
 #include "Alert.h"
+#include "SerialPort.h"
 
 // Direct port manipulation for LED
 // D13 = PORTB bit 5 (13 - 8 = 5)
 #define LED_BIT 5
 
-// ZONE THRESHOLDS
-#define ALERT_THRESHOLD 100.0   // cm - below this, warning zone starts
-#define DANGER_THRESHOLD 10.0   // cm - below this, constant alarm
+// Buzzer: D3 = PORTD bit 3 = OC2B (Timer2 Output Compare B)
+#define BUZZER_BIT 3
+
+// Arrival this soon maps onto the warning threshold (see APPROACH in Alert.h)
+#define ALERT_ARRIVAL_WINDOW 2000   // ms
+
+// Sensor "no reading" value (matches DISTANCE_MM_INVALID)
+#define DISTANCE_NONE 0xFFFF
 
 // BPM SETTINGS
 #define BASE_BPM 60             // Starting BPM at alert threshold (100cm)
@@ -19,85 +26,187 @@
 // BUZZER FREQUENCY
 // Passive buzzers need a frequency to vibrate. 2kHz is in the
 // range where human hearing is most sensitive (2-4kHz).
+//
+// TIMER2 (CTC mode, clk/32 = 500kHz):
+//   compare match every OCR2A + 1 = 125 ticks = 250μs (4kHz)
+//   OC2B toggles on each match → 2kHz square wave on D3
+// The same match interrupt paces the blink/beep rhythm.
 #define BUZZER_FREQ 2000
+#define ALERT_TICK_HZ (BUZZER_FREQ * 2)
+#define ALERT_TICKS_PER_MS (ALERT_TICK_HZ / 1000)
+#define TIMER2_TOP (F_CPU / 32 / ALERT_TICK_HZ - 1)
+
+static_assert(BUZZER_PIN == 3, "Buzzer must be on D3 (OC2B)");
+
+// ALERT ENGINE STATE:
+// Written by updateMm()/stop(), read by the Timer2 ISR.
+enum AlertMode : uint8_t {
+    ALERT_OFF,
+    ALERT_PULSE,                // Warning zone: ISR toggles LED and tone
+    ALERT_SOLID                 // Danger zone: both on, ISR idle
+};
+
+static volatile uint8_t mode = ALERT_OFF;
+static volatile uint16_t halfPeriod;    // ISR ticks per on or off phase
+static volatile uint16_t countdown;     // Ticks until the next toggle
+static volatile bool on;                // Current phase of the pulse
+
+// Connect/disconnect OC2B. Disconnected, D3 follows PORTD (low).
+// Interrupts must be off: the ISR writes TCCR2A too.
+static void sound(bool enable) {
+    if (enable) {
+        TCCR2A |= (1 << COM2B0);        // Toggle OC2B on compare match
+    } else {
+        TCCR2A &= ~(1 << COM2B0);
+    }
+}
+
+// RHYTHM ISR (4kHz):
+// Counts down the current phase and flips LED and tone together.
+// Only enabled in the warning zone, so it costs nothing otherwise.
+ISR(TIMER2_COMPA_vect) {
+    if (--countdown != 0) {
+        return;
+    }
+    countdown = halfPeriod;
+    on = !on;
+    PINB = (1 << LED_BIT);              // Toggle LED (writing to PINx toggles PORTx)
+    sound(on);
+}
 
 void Alert::init() {
-    pinMode(LED_PIN, OUTPUT);
-    pinMode(BUZZER_PIN, OUTPUT);
+    DDRB |= (1 << LED_BIT);
     PORTB &= ~(1 << LED_BIT);   // LED LOW (D13 = PORTB bit 5)
-    noTone(BUZZER_PIN);
-    active = false;
-    state = false;
-    lastToggle = 0;
-    Serial.println(F("Alert system initialized"));
+    DDRD |= (1 << BUZZER_BIT);
+    PORTD &= ~(1 << BUZZER_BIT);
+
+    // Timer2 belongs to the alert from here on (tone() is not used)
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        TCCR2A = (1 << WGM21);              // CTC, OC2B disconnected
+        TCCR2B = (1 << CS21) | (1 << CS20); // clk/32
+        OCR2A = TIMER2_TOP;
+        OCR2B = 0;
+        TCNT2 = 0;
+        TIMSK2 = 0;
+        mode = ALERT_OFF;
+    }
+    posted = DISTANCE_NONE;
+    repost = true;
+    threshold = ALERT_THRESHOLD;
+    danger = DANGER_THRESHOLD;
+    serialPort.println(F("Alert system initialized"));
 }
 
 // Calculate milliseconds between toggles for given distance
 // We toggle twice per beat (on and off), hence /2
-unsigned int Alert::getIntervalMs(float distance) {
-    // BPM increases by 2 for each cm closer
-    // At 100cm: 60 BPM, at 11cm: 238 BPM
-    int bpm = BASE_BPM + 2 * (int)(ALERT_THRESHOLD - distance);
+unsigned int Alert::getIntervalMs(uint16_t distanceMm) {
+    // BPM increases by 2 for each whole cm closer
+    // At 100cm: 60 BPM, at 11cm: 238 BPM (default thresholds)
+    int bpm = BASE_BPM + 2 * ((threshold - distanceMm) / 10);
     return MS_PER_MINUTE / bpm / 2;  // /2 because we toggle twice per beat
 }
 
+// FLOAT API:
+// Kept for callers using Ultrasonic::getDistance() (cm, -1 = invalid).
 void Alert::update(float distance) {
+    updateMm(distance < 0 ? DISTANCE_NONE : (uint16_t)(distance * 10 + 0.5f));
+}
+
+// POSTING A DISTANCE:
+// Only decides the zone and rate; the ISR produces the pattern.
+// The same distance posted again is ignored, so the caller may
+// post on every pass without paying for the division below -
+// unless repost is set. Every value, DISTANCE_NONE included, is a
+// real reading, so none of them can stand for "nothing posted".
+void Alert::updateMm(uint16_t distance) {
+    if (distance == posted && !repost) {
+        return;
+    }
+    posted = distance;
+    repost = false;
+
     // INVALID READING HANDLING:
-    // If sensor returns -1 (no echo/out of range), we stop the alert.
+    // If sensor returns no reading (no echo/out of range), we stop the alert.
     // This is the conservative approach - don't alarm if we can't measure.
     // Alternative would be to maintain last state, but that could cause
     // false alarms if sensor temporarily fails.
-    if (distance < 0) {
-        stop();
-        return;
-    }
-    
+    //
     // SAFE ZONE: Object beyond threshold
-    if (distance > ALERT_THRESHOLD) {
-        stop();
+    if (distance == DISTANCE_NONE || distance > threshold) {
+        silence();
         return;
     }
-    
+
     // DANGER ZONE: Object very close - constant alarm
     // No blinking, no timing - just full alert
-    if (distance <= DANGER_THRESHOLD) {
-        active = true;
-        state = true;
-        PORTB |= (1 << LED_BIT);    // LED HIGH
-        tone(BUZZER_PIN, BUZZER_FREQ);
+    if (distance <= danger) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            if (mode != ALERT_SOLID) {
+                mode = ALERT_SOLID;
+                TIMSK2 &= ~(1 << OCIE2A);
+                PORTB |= (1 << LED_BIT);    // LED HIGH
+                sound(true);
+            }
+        }
         return;
     }
-    
-    // WARNING ZONE: Object in range (10 < distance <= 100)
-    // Blink/beep at rate proportional to proximity
-    active = true;
-    unsigned long now = millis();
-    unsigned int interval = getIntervalMs(distance);
-    
-    // NON-BLOCKING TOGGLE:
-    // Instead of using delay(), we check if enough time has passed.
-    // This allows the main loop to continue running smoothly.
-    if (now - lastToggle >= interval) {
-        lastToggle = now;
-        state = !state;
-        
-        PINB = (1 << LED_BIT);  // Toggle LED (writing to PINx toggles PORTx)
-        
-        // Buzzer follows LED state
-        if (state) {
-            tone(BUZZER_PIN, BUZZER_FREQ);
-        } else {
-            noTone(BUZZER_PIN);
+
+    // WARNING ZONE: Object in range (danger < distance <= threshold)
+    // Blink/beep at rate proportional to proximity.
+    uint16_t ticks = getIntervalMs(distance) * ALERT_TICKS_PER_MS;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        halfPeriod = ticks;
+        if (mode != ALERT_PULSE) {
+            // ENTERING: start on a beat right away
+            mode = ALERT_PULSE;
+            on = true;
+            countdown = ticks;
+            PORTB |= (1 << LED_BIT);
+            sound(true);
+            TIFR2 = (1 << OCF2A);           // Clear stale match flag
+            TIMSK2 |= (1 << OCIE2A);
+        } else if (countdown > ticks) {
+            // CLOSER: don't finish a long phase at the old rate
+            countdown = ticks;
         }
     }
 }
 
-void Alert::stop() {
-    // Only act if currently active (avoid unnecessary writes)
-    if (active) {
-        active = false;
-        state = false;
-        PORTB &= ~(1 << LED_BIT);   // LED LOW
-        noTone(BUZZER_PIN);
+// APPROACH:
+// The sooner of "is near" and "will be near" decides the zone.
+void Alert::updateApproach(uint16_t distance, uint16_t arrivalMs) {
+    if (arrivalMs < ALERT_ARRIVAL_WINDOW) {
+        uint16_t urgent = (uint32_t)arrivalMs * threshold / ALERT_ARRIVAL_WINDOW;
+        if (urgent < distance) {
+            distance = urgent;
+        }
+    }
+    updateMm(distance);
+}
+
+// THRESHOLDS:
+// The next posted distance is judged against the new zones, even
+// if it is the same as the last one.
+void Alert::setThresholds(uint16_t warnMm, uint16_t dangerMm) {
+    threshold = warnMm;
+    danger = dangerMm;
+    repost = true;
+}
+
+void Alert::silence() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // Only act if currently active (avoid unnecessary writes)
+        if (mode != ALERT_OFF) {
+            mode = ALERT_OFF;
+            TIMSK2 &= ~(1 << OCIE2A);
+            sound(false);
+            PORTB &= ~(1 << LED_BIT);   // LED LOW
+        }
     }
-}
\ No newline at end of file
+}
+
+void Alert::stop() {
+    silence();
+    repost = true;
+}
@@ -9,6 +9,8 @@
 //   Safe zone (>100cm):      No alert - LED off, buzzer silent
 //   Warning zone (10-100cm): Pulsing alert - rate increases with proximity
 //   Danger zone (≤10cm):     Constant alert - LED solid, buzzer continuous
+// These are the default limits; setThresholds() moves them at
+// run time (ALERT command, see Settings.h).
 //
 // BPM CALCULATION:
 // In warning zone, alert rate follows: BPM = 60 + 2×(100 - distance)
@@ -18,25 +20,57 @@
 //
 // PASSIVE BUZZER NOTE:
 // Passive buzzers require a frequency signal to produce sound.
-// We use tone() at 2kHz for maximum audibility.
+// We use a 2kHz square wave for maximum audibility.
 // Active buzzers would use digitalWrite() instead.
+//
+// TIMER-DRIVEN ENGINE:
+// The scan loop only posts the latest distance with updateMm().
+// Timer2 does the rest on its own:
+//   - generates the 2kHz tone in hardware on OC2B (D3), switched
+//     on and off by connecting the pin - no tone()/noTone() calls
+//     reprogramming the timer on every beep
+//   - its 4kHz compare interrupt times each blink/beep phase
+// The rhythm is exact to 250μs however slowly the sweep steps,
+// and a closer object shortens the current phase immediately.
+//
+// APPROACH (ENABLE_TRACKING):
+// updateApproach() also takes the time until the nearest
+// approaching object arrives (see Tracker.h). Arriving within
+// ALERT_ARRIVAL_WINDOW counts as being at the distance that
+// time maps to on the same zones:
+//   2s → 100cm (threshold), 1s → 50cm, 0.2s → 10cm (danger)
+// A wall at 90cm gets the 90cm rate - and so does a person still
+// 180cm away but closing at 1m/s.
 
 #ifndef ALERT_H
 #define ALERT_H
 
 #include "config.h"
+#include "Hal.h"
+
+// ZONE THRESHOLDS (defaults, see setThresholds())
+// Kept in mm so the per-sample path is integer-only
+#define ALERT_THRESHOLD 1000    // mm - below this, warning zone starts
+#define DANGER_THRESHOLD 100    // mm - below this, constant alarm
 
-class Alert {
+class Alert : public ProximityAlert {
 public:
     void init();
-    void update(float distance);    // Call every loop - handles timing internally
-    void stop();                    // Force stop (used when scanning stops)
-    
+    void update(float distance);    // Post latest distance (cm, -1 = invalid)
+    void updateMm(uint16_t distanceMm) override;    // Same, integer mm (0xFFFF = invalid)
+    void updateApproach(uint16_t distanceMm, uint16_t arrivalMs) override;
+    void stop() override;           // Force stop (used when scanning stops)
+
+    // Zone limits in mm, dangerMm < warnMm (defaults above)
+    void setThresholds(uint16_t warnMm, uint16_t dangerMm);
+
 private:
-    bool active;                    // Is alert currently running?
-    bool state;                     // Current toggle state (on/off)
-    unsigned long lastToggle;       // Timestamp of last state change
-    unsigned int getIntervalMs(float distance);  // Calculate toggle interval from distance
+    uint16_t posted;                // Last distance posted (mm)
+    bool repost;                    // Judge the next posting even if it repeats
+    uint16_t threshold;             // mm, warning zone starts
+    uint16_t danger;                // mm, constant alarm
+    void silence();                 // LED off, tone off, ISR off
+    unsigned int getIntervalMs(uint16_t distanceMm);  // Calculate toggle interval from distance
 };
 
 #endif
\ No newline at end of file
@@ -2,7 +2,9 @@
 // Debounced Push Button Implementation
 
 #include <Arduino.h>
+#include <util/atomic.h>
 #include "Button.h"
+#include "SerialPort.h"
 
 // DEBOUNCE TIMING:
 // 50ms is a safe value that filters most mechanical bounce
@@ -11,40 +13,91 @@
 // Human perception threshold: ~100ms
 #define DEBOUNCE_DELAY 50  // ms
 
+// ISR STATE:
+// Ring of events, written by pinChange(), read by getEvent().
+// One slot stays empty to tell full from empty.
+static volatile ButtonEvent queue[BUTTON_QUEUE_SIZE];
+static volatile uint8_t queueHead;      // Next slot to write (ISR)
+static volatile uint8_t queueTail;      // Next slot to read
+static volatile bool level;             // Debounced: true = pressed
+static volatile unsigned long lastEdge; // millis() of last accepted edge
+
+// Queue an edge. A full queue drops it - the 2-press backlog
+// already says more than the user meant.
+static void push(bool pressed, unsigned long now) {
+    uint8_t next = (queueHead + 1) & (BUTTON_QUEUE_SIZE - 1);
+    level = pressed;
+    lastEdge = now;
+    if (next == queueTail) {
+        return;
+    }
+    queue[queueHead].time = now;
+    queue[queueHead].pressed = pressed;
+    queueHead = next;
+}
+
+void Button::pinChange(uint8_t pins) {
+    bool pressed = (pins & (1 << BUTTON_BIT)) == 0;     // Active LOW
+    unsigned long now = millis();
+
+    // Bounce: inside the window, or back to the level we already have
+    if (pressed == level || now - lastEdge < DEBOUNCE_DELAY) {
+        return;
+    }
+    push(pressed, now);
+}
+
 void Button::init() {
     // INPUT_PULLUP enables internal ~20kΩ pull-up resistor
     // This means: released = HIGH, pressed = LOW
     // No external resistor needed in the circuit
     pinMode(BUTTON_PIN, INPUT_PULLUP);  // Active LOW
-    lastState = HIGH;           // Assume button starts released
-    lastDebounceTime = 0;
-    Serial.println(F("Button initialized")); 
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        queueHead = 0;
+        queueTail = 0;
+        level = false;                  // Assume button starts released
+        lastEdge = millis() - DEBOUNCE_DELAY;
+        PCMSK2 |= (1 << BUTTON_BIT);    // D6 = PCINT22
+        PCIFR = (1 << PCIF2);           // Clear stale flag
+        PCICR |= (1 << PCIE2);
+    }
+    serialPort.println(F("Button initialized")); 
 }
 
-bool Button::isPressed() {
-    bool reading = (PIND & (1 << 6)) != 0;  // D6: HIGH when released, LOW when pressed
-    unsigned long now = millis();
-    
-    // EDGE DETECTION:
-    // We only care about HIGH→LOW transitions (button press)
-    // LOW→HIGH (button release) is ignored
-    if (lastState == HIGH && reading == LOW) {
-
-        // DEBOUNCE CHECK:
-        // Has enough time passed since last valid press?
-        if (now - lastDebounceTime > DEBOUNCE_DELAY) {
-            lastDebounceTime = now;
-            lastState = reading;
-            return true;    // Valid press detected
+bool Button::hasEvent() {
+    return queueHead != queueTail;
+}
+
+bool Button::getEvent(ButtonEvent* event) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // SETTLE CHECK:
+        // Edges inside the debounce window are dropped, so the
+        // final one of a short tap can be too. Once the window
+        // has passed with the pin on the other level, queue it.
+        bool pressed = (BUTTON_PINR & (1 << BUTTON_BIT)) == 0;
+        unsigned long now = millis();
+        if (pressed != level && now - lastEdge >= DEBOUNCE_DELAY) {
+            push(pressed, now);
         }
 
-        // Within debounce period - ignore this press.
-        // We don't update lastState here so that we can
-        // detect a genuine new press after cooldown.
-        return false;
+        if (queueTail == queueHead) {
+            return false;
+        }
+        event->time = queue[queueTail].time;
+        event->pressed = queue[queueTail].pressed;
+        queueTail = (queueTail + 1) & (BUTTON_QUEUE_SIZE - 1);
+    }
+    return true;
+}
+
+bool Button::isPressed() {
+    // Releases are only queued to keep presses paired; skip them
+    ButtonEvent event;
+    while (getEvent(&event)) {
+        if (event.pressed) {
+            return true;
+        }
     }
-    
-    // No transition detected (or it's a release) - safe to update state
-    lastState = reading;
     return false;
-}
\ No newline at end of file
+}
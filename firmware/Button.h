@@ -17,10 +17,18 @@
 //   Electrical signal:  ___##_#_##_#___  (bouncing)
 //   After debounce:     ___########___   (clean)
 //
-// DEBOUNCE STRATEGY:
-// We use a 50ms cooldown after detecting a transition.
-// Any transitions during cooldown are ignored.
-// The press event is preserved until cooldown expires.
+// INTERRUPT-DRIVEN:
+// Polling only sees a press if the pin is still low at the next
+// poll. Instead a pin change interrupt on D6 catches every edge
+// and queues a timestamped event, so a short press is never lost
+// however busy the main loop is. isPressed() just drains the
+// queue.
+//
+// DEBOUNCE STRATEGY (in the ISR):
+// An edge that changes the debounced level is queued, then the
+// 50ms after it are ignored. If the contacts settle in that window
+// on the other level (a tap shorter than 50ms), getEvent() queues
+// the missed edge itself once the window has passed.
 //
 // ACTIVE LOW CONFIGURATION:
 // Button uses INPUT_PULLUP, meaning:
@@ -32,14 +40,24 @@
 
 #include "config.h"
 
+// Event queue length (power of two). Four covers two full
+// press/release cycles between drains.
+#define BUTTON_QUEUE_SIZE 4
+
+struct ButtonEvent {
+    unsigned long time;     // millis() of the edge
+    bool pressed;           // true = press, false = release
+};
+
 class Button {
 public:
     void init();
-    bool isPressed();      // Returns true ONCE per press (edge-triggered, debounced)
-    
-private:
-    bool lastState;                 // Previous reading (HIGH = released, LOW = pressed)
-    unsigned long lastDebounceTime; // Timestamp of last valid transition
+    bool isPressed();                   // Returns true ONCE per press (edge-triggered, debounced)
+    bool getEvent(ButtonEvent* event);  // Oldest queued press or release, false if none
+
+    // Called from the shared PCINT2 ISR with the sampled port D
+    static void pinChange(uint8_t pins);
+    static bool hasEvent();             // Queue not empty (safe with interrupts off)
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,89 @@
+// CommandLine.cpp
+// Line assembly and tokenizing for serial commands
+
+#include <Arduino.h>
+#include "CommandLine.h"
+#include "SerialPort.h"
+
+CommandLine::CommandLine() {
+    length = 0;
+    overflow = false;
+    tokenCount = 0;
+}
+
+static bool isSeparator(char c) {
+    return c == ' ' || c == ',' || c == '\t';
+}
+
+// TOKENIZE IN PLACE:
+// Separators become terminators; tokens point into the buffer.
+// Too many tokens invalidates the line like an overlong one.
+void CommandLine::split() {
+    tokenCount = 0;
+    bool inToken = false;
+
+    for (uint8_t i = 0; i < length; i++) {
+        if (isSeparator(buffer[i])) {
+            buffer[i] = '\0';
+            inToken = false;
+        } else if (!inToken) {
+            if (tokenCount == COMMAND_MAX_TOKENS) {
+                tokenCount = 0;
+                return;
+            }
+            tokens[tokenCount++] = &buffer[i];
+            inToken = true;
+        }
+    }
+}
+
+bool CommandLine::poll() {
+    int c;
+    while ((c = serialPort.read()) >= 0) {
+        if (c == '\r' || c == '\n') {
+            bool empty = length == 0 && !overflow;
+            buffer[length] = '\0';
+            if (overflow) {
+                tokenCount = 0;
+            } else {
+                split();
+            }
+            length = 0;
+            overflow = false;
+            if (!empty) {
+                return true;    // Rest of the RX buffer waits for the next poll
+            }
+        } else if (length < COMMAND_LINE_MAX) {
+            buffer[length++] = toupper(c);
+        } else {
+            overflow = true;
+        }
+    }
+    return false;
+}
+
+uint8_t CommandLine::count() {
+    return tokenCount;
+}
+
+bool CommandLine::is(uint8_t index, const char* word) {
+    return index < tokenCount && strcmp_P(tokens[index], word) == 0;
+}
+
+bool CommandLine::number(uint8_t index, uint16_t* value) {
+    if (index >= tokenCount) {
+        return false;
+    }
+    uint32_t n = 0;
+    for (const char* p = tokens[index]; *p; p++) {
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+        n = n * 10 + (*p - '0');
+        if (n > 0xFFFF) {
+            return false;
+        }
+    }
+    *value = n;
+    return true;
+}
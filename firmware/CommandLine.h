@@ -0,0 +1,52 @@
+// CommandLine.h
+// Non-Blocking Serial Command Reader
+//
+// PURPOSE:
+// Collects serial RX bytes into command lines without ever
+// waiting for the rest of a line: poll() takes whatever the RX
+// buffer holds and returns at once, so a command typed slowly by
+// hand costs the scan loop nothing until its newline arrives.
+//
+// LINE FORMAT:
+//   WORD [ARG [ARG]]\n
+// Tokens are separated by spaces or commas and upper-cased on
+// the way in, so "range 40 140" and "RANGE,40,140" are the same.
+// '\r', '\n' or both end a line; empty lines are ignored. A line
+// longer than COMMAND_LINE_MAX is dropped whole and reported as
+// one bad line, never run half-read.
+//
+// Text, not a binary protocol: commands are rare, typed by an
+// operator as often as sent by a tool, and the replies share the
+// link with CSV output either way.
+
+#ifndef COMMAND_LINE_H
+#define COMMAND_LINE_H
+
+#include "config.h"
+
+#define COMMAND_LINE_MAX   24   // Characters, excluding the terminator
+#define COMMAND_MAX_TOKENS 3    // Command word plus two arguments
+
+class CommandLine {
+public:
+    CommandLine();
+
+    // Read the RX buffer; true when a complete line is ready.
+    // The line stays available until the next poll().
+    bool poll();
+
+    uint8_t count();                            // Tokens, 0 = line too long or too many tokens
+    bool is(uint8_t index, const char* word);   // Token equals word (PSTR, upper case)
+    bool number(uint8_t index, uint16_t* value);    // Token as decimal 0-65535
+
+private:
+    char buffer[COMMAND_LINE_MAX + 1];
+    uint8_t length;
+    bool overflow;              // Current line is too long
+    char* tokens[COMMAND_MAX_TOKENS];
+    uint8_t tokenCount;
+
+    void split();
+};
+
+#endif
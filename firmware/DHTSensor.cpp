@@ -2,7 +2,11 @@
 // Non-blocking DHT11 temperature/humidity reader with caching
 
 #include <Arduino.h>
+#include <util/atomic.h>
+#include "Button.h"
 #include "DHTSensor.h"
+#include "Timer1.h"
+#include "SerialPort.h"
 
 // TIMING:
 // DHT11 datasheet requires minimum 1 second between readings.
@@ -10,60 +14,237 @@
 // conditions don't change rapidly anyway.
 #define DHT_READ_INTERVAL 2000
 
-DHTSensor::DHTSensor() : dht(DHT_PIN, DHT_TYPE), lastReadTime(0) {
+// STALE READINGS:
+// A failed transaction (checksum, out of range, no response)
+// keeps the last good reading: 10s on, the air is still the same
+// to well within the DHT11's ±2°C. After this many failures in a
+// row - 10s without a good reading - it is dropped.
+#define DHT_STALE_FAILURES 5
+
+// Start signal: datasheet minimum is 18ms
+#define DHT_START_LOW_MS 20
+
+// Whole transaction is ~4ms; allow generous slack before giving up
+#define DHT_RECEIVE_TIMEOUT_MS 10
+
+// BIT DECODING:
+// Falling edge to falling edge = 50μs LOW + HIGH time:
+//   "0" ≈ 50 + 27 = 77μs,  "1" ≈ 50 + 70 = 120μs
+// Threshold halfway, in Timer1 ticks (0.5μs).
+#define DHT_ONE_THRESHOLD (100 * TIMER1_TICKS_PER_US)
+
+// Falling edges per transaction:
+// F0 response start, F1 first bit start, then one per bit (F2-F41)
+#define DHT_EDGES 42
+
+// ISR STATE:
+// Written by the pin-change ISR, read by read() when done.
+static volatile uint8_t dhtData[5];
+static volatile uint8_t dhtEdges;
+static volatile uint16_t dhtLastEdge;
+
+// Port D as of the last interrupt, to tell which pin changed
+static uint8_t lastPins = 0xFF;         // Both lines idle HIGH
+
+// PIN-CHANGE ISR (PCINT2 = port D: D4 DHT, D6 button):
+// One vector serves the whole port, so compare against the last
+// sample to see which pin moved. Button edges are handed to
+// Button::pinChange(); the timestamp is taken first so a button
+// edge cannot delay a DHT bit.
+//
+// DHT: fires on both edges; we use falling edges only. The gap
+// since the previous falling edge tells us whether the bit was
+// 0 or 1, so each bit is shifted in as it arrives - no buffer
+// of timestamps needed.
+//
+// Edge k (k ≥ 2) completes bit k-2, MSB first.
+ISR(PCINT2_vect) {
+    uint16_t now = TCNT1;
+    uint8_t pins = PIND;
+    uint8_t changed = (pins ^ lastPins) & PCMSK2;
+    lastPins = pins;
+
+    if (changed & (1 << BUTTON_BIT)) {
+        Button::pinChange(pins);
+    }
+    if (!(changed & (1 << DHT_BIT)) || (pins & (1 << DHT_BIT))) {
+        return;                         // Not a DHT falling edge
+    }
+
+    uint8_t edge = dhtEdges;
+
+    if (edge >= 2 && edge < DHT_EDGES) {
+        uint8_t byteIndex = (edge - 2) >> 3;
+        uint8_t value = dhtData[byteIndex] << 1;
+        if ((uint16_t)(now - dhtLastEdge) > DHT_ONE_THRESHOLD) {
+            value |= 1;
+        }
+        dhtData[byteIndex] = value;
+    }
+
+    dhtLastEdge = now;
+    if (edge < DHT_EDGES) {
+        dhtEdges = edge + 1;
+    }
+}
+
+DHTSensor::DHTSensor() : phase(DHT_IDLE), phaseStart(0), lastReadTime(0), failures(0) {
     lastReading.valid = false;
 }
 
 void DHTSensor::init() {
-    dht.begin();
+    timer1Init();                       // Edge timestamps come from Timer1
+
+    // Idle state: DATA released, pulled HIGH
+    DHT_DDR &= ~(1 << DHT_BIT);
+    DHT_PORT |= (1 << DHT_BIT);         // Internal pull-up
 
     // DHT11 needs 1 second after power-on before first reading
-    // (datasheet: "pass the unstable status")
-    delay(1000);
+    // (datasheet: "pass the unstable status").
+    // Instead of delay(1000), the first transaction simply starts
+    // one full read interval (2s) from now.
+    lastReadTime = millis();
+    phase = DHT_IDLE;
 
-    Serial.println(F("DHT11 initialized"));
+    serialPort.println(F("DHT11 initialized"));
 }
 
-bool DHTSensor::read(THReading* result) {
-    unsigned long now = millis();
-    
-    // CACHING PATTERN:
-    // If called too soon, return the cached reading without
-    // blocking. This allows the main loop to continue smoothly.
-    if (now - lastReadTime < DHT_READ_INTERVAL) {
-        *result = lastReading;
-        return false;  // not a new reading
+void DHTSensor::startTransaction() {
+    // START SIGNAL: drive DATA LOW
+    DHT_PORT &= ~(1 << DHT_BIT);
+    DHT_DDR |= (1 << DHT_BIT);
+    phaseStart = millis();
+    phase = DHT_START;
+}
+
+void DHTSensor::releaseLine() {
+    // ARM EDGE CAPTURE before releasing, so the sensor's response
+    // (20-40μs after release) cannot be missed.
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t i = 0; i < 5; i++) {
+            dhtData[i] = 0;
+        }
+        dhtEdges = 0;
+        PCMSK2 |= (1 << DHT_BIT);       // D4 = PCINT20
+        PCIFR = (1 << PCIF2);           // Clear stale flag
+        PCICR |= (1 << PCIE2);
     }
-    
-    lastReadTime = now;
-    
-    // Read sensor (this blocks for ~25ms)
-    float h = dht.readHumidity();
-    float tC = dht.readTemperature();
-    float tF = dht.readTemperature(true);
-    
-    // Check for NaN (sensor communication error)
-    if (isnan(h) || isnan(tC) || isnan(tF)) {
-        Serial.println(F("DHT read failed"));
-        result->valid = false;
+
+    // RELEASE: input with pull-up → line goes HIGH
+    DHT_DDR &= ~(1 << DHT_BIT);
+    DHT_PORT |= (1 << DHT_BIT);
+
+    phaseStart = millis();
+    phase = DHT_RECEIVE;
+}
+
+void DHTSensor::endTransaction() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        PCMSK2 &= ~(1 << DHT_BIT);
+        if (PCMSK2 == 0) {
+            PCICR &= ~(1 << PCIE2);     // No other port D pin using it
+        }
+    }
+    phase = DHT_IDLE;
+}
+
+bool DHTSensor::decode() {
+    uint8_t data[5];
+    for (uint8_t i = 0; i < 5; i++) {
+        data[i] = dhtData[i];
+    }
+
+    // CHECKSUM: low byte of the sum of the first four bytes
+    if ((uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4]) {
+        serialPort.println(F("DHT read failed"));
         return false;
     }
 
+    // DATA FORMAT:
+    // Humidity: integral + decimal byte (decimal is 0 on most DHT11s)
+    // Temperature: bit 7 of the decimal byte is the sign
+    float h = data[0] + data[1] * 0.1f;
+    float tC = data[2] + (data[3] & 0x0F) * 0.1f;
+    int16_t tC10 = data[2] * 10 + (data[3] & 0x0F);
+    if (data[3] & 0x80) {
+        tC = -tC;
+        tC10 = -tC10;
+    }
+
     // Validate against sensor's reliable range
     // Values outside this range indicate sensor malfunction
     if (tC < DHT_MIN_TEMP || tC > DHT_MAX_TEMP ||
         h < DHT_MIN_HUMIDITY || h > DHT_MAX_HUMIDITY) {
-        Serial.println(F("DHT reading out of range"));
-        result->valid = false;
+        serialPort.println(F("DHT reading out of range"));
         return false;
     }
     
     // Cache the valid reading
+    // °F derived from °C instead of a second sensor transaction
     lastReading.humidity = h;
     lastReading.temperatureC = tC;
-    lastReading.temperatureF = tF;
+    lastReading.temperatureF = tC * 1.8f + 32;
+    lastReading.temperatureC10 = tC10;
+    lastReading.humidityRH = data[0] + (data[1] >= 5);
     lastReading.valid = true;
-    
+    failures = 0;
+    return true;
+}
+
+// See STALE READINGS
+void DHTSensor::readFailed(THReading* result) {
+    if (failures < DHT_STALE_FAILURES && ++failures == DHT_STALE_FAILURES) {
+        lastReading.valid = false;
+    }
+    *result = lastReading;
+}
+
+bool DHTSensor::isBusy() {
+    return phase != DHT_IDLE;
+}
+
+bool DHTSensor::read(THReading* result) {
+    unsigned long now = millis();
+
+    // CACHING PATTERN:
+    // Unless a transaction finishes during this call, return the
+    // cached reading - also when it fails, until the reading goes
+    // stale. Each phase only checks a deadline or a flag, so this
+    // never blocks.
     *result = lastReading;
-    return true;  // new reading taken
-}
\ No newline at end of file
+
+    switch (phase) {
+        case DHT_IDLE:
+            if (now - lastReadTime >= DHT_READ_INTERVAL) {
+                lastReadTime = now;
+                startTransaction();
+            }
+            return false;
+
+        case DHT_START:
+            if (now - phaseStart >= DHT_START_LOW_MS) {
+                releaseLine();
+            }
+            return false;
+
+        case DHT_RECEIVE:
+            if (dhtEdges >= DHT_EDGES) {
+                endTransaction();
+                if (!decode()) {
+                    readFailed(result);
+                    return false;
+                }
+                *result = lastReading;
+                return true;    // new reading taken
+            }
+            if (now - phaseStart > DHT_RECEIVE_TIMEOUT_MS) {
+                // Sensor missing or response incomplete
+                endTransaction();
+                serialPort.println(F("DHT read failed"));
+                readFailed(result);
+            }
+            return false;
+    }
+
+    return false;
+}
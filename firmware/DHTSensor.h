@@ -11,21 +11,38 @@
 //   - Sampling period: minimum 1 second between readings
 //   - Startup time: 1 second after power-on
 //
+// SINGLE-WIRE PROTOCOL:
+//   Host:   pull DATA low ≥18ms, then release (pull-up → HIGH)
+//   Sensor: 80μs LOW + 80μs HIGH (response)
+//           40 bits, each 50μs LOW + HIGH of 26-28μs ("0") or 70μs ("1")
+//           bytes: RH int, RH dec, T int, T dec, checksum
+//
+//   DATA: ‾‾|__18ms__|‾‾|_80_|‾80‾|_50_|‾27‾|_50_|‾‾70‾‾|_50_| ...
+//                        F0        F1       F2          F3
+//
 // NON-BLOCKING PATTERN:
-// DHT11 readings take ~25ms and block execution.
-// Instead of reading every loop, we cache the last valid
-// reading and only update every 2 seconds. This keeps
-// the radar sweep smooth while still tracking environmental
-// changes.
+// The DHT library bit-bangs the whole transaction with interrupts
+// disabled, blocking ~25ms per call (and we needed three calls).
+// Instead, we run the transaction as a state machine across
+// several read() calls:
+//   IDLE    → interval elapsed: drive DATA low
+//   START   → 18ms later (not waited for): release DATA, arm PCINT
+//   RECEIVE → ISR decodes bits from falling-edge spacing
+//             (Timer1 timestamps); done after 42 edges or timeout
+// Nothing blocks, and other interrupts keep running.
+//
+// One transaction per interval; °F is derived from °C.
+//
+// FAILED READS:
+// A bad frame or no response keeps the previous reading, so one
+// glitch doesn't throw the distance scale back to the default.
+// Only after several failures in a row (10s, see STALE READINGS
+// in DHTSensor.cpp) does read() report valid = false.
 
 #ifndef DHTSENSOR_H
 #define DHTSENSOR_H
 
 #include "config.h"
-#include <DHT.h>
-
-// DHT11 sensor type for library
-#define DHT_TYPE DHT11
 
 // Valid ranges (from datasheet)
 // Readings outside these are likely sensor errors
@@ -34,16 +51,32 @@
 #define DHT_MIN_HUMIDITY 20.0
 #define DHT_MAX_HUMIDITY 90.0
 
+// Transaction phases (see NON-BLOCKING PATTERN above)
+enum DHTPhase : uint8_t {
+    DHT_IDLE,
+    DHT_START,
+    DHT_RECEIVE
+};
+
 class DHTSensor {
 public:
     DHTSensor();
     void init();
-    bool read(THReading* result);   // Returns true if new reading taken
+    bool read(THReading* result);   // Call often; returns true when a new reading completes
+    bool isBusy();                  // Transaction in progress (uses Timer1)
     
 private:
-    DHT dht;
+    DHTPhase phase;
+    unsigned long phaseStart;       // millis() when current phase began
     unsigned long lastReadTime;
     THReading lastReading;          // Cached reading for non-blocking access
+    uint8_t failures;               // Failed transactions since the last good one
+
+    void startTransaction();        // IDLE → START
+    void releaseLine();             // START → RECEIVE
+    void endTransaction();          // RECEIVE → IDLE
+    bool decode();                  // Validate and cache received bytes
+    void readFailed(THReading* result);     // Keep or drop the cached reading
 };
 
-#endif
\ No newline at end of file
+#endif
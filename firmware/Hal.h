@@ -0,0 +1,60 @@
+// Hal.h
+// Hardware Abstraction Interfaces
+//
+// PURPOSE:
+// Scanner only needs a handful of operations from its components.
+// These interfaces capture exactly those, so Scanner depends on
+// "something that measures distance" rather than on the HC-SR04
+// driver and its AVR registers.
+//
+// On the Arduino the concrete drivers implement them:
+//   RangeSensor    ← Ultrasonic
+//   SweepServo     ← ServoMotor
+//   ProximityAlert ← Alert
+//
+// The host build (see host/) implements them with simulated parts,
+// so the unchanged Scanner logic can be benchmarked on a PC.
+//
+// COST:
+// One vtable per class (a few bytes of SRAM on AVR) and an
+// indirect call per use - negligible next to a 25ms echo wait.
+// Destructors are protected and non-virtual: components are
+// global objects and never deleted through these pointers.
+
+#ifndef HAL_H
+#define HAL_H
+
+#include "config.h"
+
+class RangeSensor {
+public:
+    virtual void startMeasurement() = 0;        // Trigger and return immediately
+    virtual bool isReady() = 0;                 // True when echo captured or timed out
+    virtual void cancel() = 0;                  // Abandon a measurement in flight
+    virtual uint16_t resultMm(uint16_t scale) = 0;  // mm, DISTANCE_MM_INVALID or _BEYOND
+    virtual uint16_t resultTicks() = 0;         // Raw echo width, ECHO_TICKS_NONE or _BEYOND
+    virtual void setRangeGate(uint16_t gateMm, uint16_t scale) = 0;     // 0 = full range
+
+protected:
+    ~RangeSensor() {}
+};
+
+class SweepServo {
+public:
+    virtual unsigned long moveTo(int angle) = 0;    // Returns micros() settle deadline
+
+protected:
+    ~SweepServo() {}
+};
+
+class ProximityAlert {
+public:
+    virtual void updateMm(uint16_t distanceMm) = 0; // Post latest distance
+    virtual void updateApproach(uint16_t distanceMm, uint16_t arrivalMs) = 0;  // Same, plus time to arrival (ENABLE_TRACKING)
+    virtual void stop() = 0;
+
+protected:
+    ~ProximityAlert() {}
+};
+
+#endif
@@ -0,0 +1,73 @@
+// Memory.cpp
+// Stack painting and SRAM report
+
+#include <Arduino.h>
+#include "Memory.h"
+#include "SerialPort.h"
+
+// Linker symbols (avr-libc):
+//   __data_start  first byte of .data (start of static RAM)
+//   __heap_start  end of .bss, where the heap would start
+//   __brkval      current heap top, 0 until malloc() is used
+//   __stack       RAMEND, where the stack starts
+extern uint8_t __data_start;
+extern uint8_t __heap_start;
+extern uint8_t __stack;
+extern char* __brkval;
+
+#define CANARY 0xC5
+
+// PAINT:
+// Naked and in .init3: runs inline during startup, after the
+// stack pointer and zero register are set up (.init2) but before
+// .data/.bss are initialized (.init4) and constructors (.init6).
+// Nothing is on the stack yet, so painting up to RAMEND is safe;
+// the loop only uses registers.
+void memoryPaint() __attribute__((naked, used, section(".init3")));
+
+void memoryPaint() {
+    for (uint8_t* p = &__heap_start; p <= &__stack; p++) {
+        *p = CANARY;
+    }
+}
+
+static uint8_t* heapEnd() {
+    return __brkval ? (uint8_t*)__brkval : &__heap_start;
+}
+
+uint16_t memoryStatic() {
+    return &__heap_start - &__data_start;
+}
+
+uint16_t memoryFree() {
+    return SP - (uintptr_t)heapEnd();
+}
+
+// HIGH-WATER MARK:
+// Scan up from the heap until the first byte the stack has
+// overwritten. A stack frame that happened to store 0xC5 right
+// at the edge would hide one byte - close enough.
+uint16_t memoryUnused() {
+    const uint8_t* p = heapEnd();
+    uint16_t unused = 0;
+    while (p <= &__stack && *p == CANARY) {
+        p++;
+        unused++;
+    }
+    return unused;
+}
+
+void memoryReportItem(const __FlashStringHelper* name, uint16_t bytes) {
+    serialPort.print(F("MEMORY,"));
+    serialPort.print(name);
+    serialPort.print(',');
+    serialPort.println(bytes);
+}
+
+void memoryReportTotals(uint16_t objectBytes) {
+    uint16_t total = memoryStatic();
+    memoryReportItem(F("static"), total);
+    memoryReportItem(F("other"), total - objectBytes);
+    memoryReportItem(F("free"), memoryFree());
+    memoryReportItem(F("unused"), memoryUnused());
+}
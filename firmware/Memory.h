@@ -0,0 +1,54 @@
+// Memory.h
+// SRAM Usage and Stack Headroom
+//
+// PURPOSE:
+// The ATmega328P has 2KB of SRAM for everything: globals, the
+// serial rings, the frame buffer, tracks - and the stack, which
+// grows down towards them with nothing to stop it. This module
+// shows how much is left, and how close the stack has come.
+//
+//   0x100                                            0x8FF
+//   [ .data | .bss | heap →       free       ← stack ]
+//                  ^ static end      painted ^ SP
+//
+// STACK PAINTING:
+// Before main() runs (.init3, ahead of constructors), everything
+// from the end of .bss to RAMEND is filled with a canary byte.
+// Whatever the stack (or heap) ever touches loses the pattern,
+// so counting canary bytes still intact above the heap gives the
+// high-water mark: the least headroom there has ever been.
+// The paint takes under 1ms at boot and nothing afterwards.
+//
+// An ISR firing on the deepest call chain counts too, so run
+// the scan for a while (keyframes, DHT, alert, all sensors)
+// before trusting the figure.
+//
+// REPORT FORMAT (text, one line per item, on 'M' over serial):
+//   MEMORY,<item>,<bytes>
+// Items: one per global object (firmware.ino), then
+//   static   .data + .bss in total
+//   other    static minus the objects listed (file-scope state,
+//            vtables, Arduino core)
+//   free     between heap and stack right now
+//   unused   never touched since boot (stack high-water mark)
+// Binary receivers skip these lines like any other text.
+
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include "config.h"
+
+// Warn at boot when less than this is free: the deepest paths
+// (ISR on top of printData on top of a scheduler task) need
+// about this much stack
+#define MEMORY_LOW_WATER 256    // bytes
+
+uint16_t memoryStatic();        // .data + .bss
+uint16_t memoryFree();          // Heap end to stack pointer, now
+uint16_t memoryUnused();        // Canary bytes left (high-water mark)
+
+// Report (see REPORT FORMAT): objects first, then totals
+void memoryReportItem(const __FlashStringHelper* name, uint16_t bytes);
+void memoryReportTotals(uint16_t objectBytes);  // objectBytes: sum of the items
+
+#endif
@@ -0,0 +1,49 @@
+// Power.cpp
+// Low-power idle - sleep until button or serial activity
+
+#include <Arduino.h>
+#include <avr/sleep.h>
+#include "Button.h"
+#include "Power.h"
+#include "SerialPort.h"
+#include "Timer1.h"
+
+// Serial RX pin (D0 = PORTD bit 0 = PCINT16)
+#define RX_BIT 0
+
+void powerSleep() {
+    serialPort.flush();             // The UART stops mid-byte otherwise
+
+    uint8_t adc = ADCSRA;
+    ADCSRA = adc & ~(1 << ADEN);
+    timer1Stop();
+
+    // millis() would wake SLEEP_MODE_IDLE every 1ms; stop it there
+    // too, so in either mode only the button or RX end the sleep
+    uint8_t timer0 = TIMSK0;
+    TIMSK0 = timer0 & ~(1 << TOIE0);
+    set_sleep_mode(IDLE_SLEEP_MODE);
+
+    // RACE-FREE SLEEP:
+    // Check for pending work with interrupts off. sei() takes
+    // effect after the next instruction, so an interrupt arriving
+    // now is taken after sleep_cpu() - and wakes us - instead of
+    // before it, where we would sleep through it.
+    cli();
+    if (!Button::hasEvent() && !serialPort.available()) {
+        PCMSK2 |= (1 << RX_BIT);        // Wake on RX activity (shared PCINT2 ISR)
+        PCIFR = (1 << PCIF2);
+        sleep_enable();
+        sleep_bod_disable();            // Brown-out detector off while asleep
+        sei();
+        sleep_cpu();
+        sleep_disable();
+        cli();
+        PCMSK2 &= ~(1 << RX_BIT);
+    }
+    sei();
+
+    TIMSK0 = timer0;
+    timer1Resume();
+    ADCSRA = adc;
+}
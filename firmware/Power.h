@@ -0,0 +1,49 @@
+// Power.h
+// Low-Power Idle
+//
+// PURPOSE:
+// Between scans the main loop has nothing to do but wait for the
+// button. Spinning through the scheduler keeps the CPU at full
+// power (~15mA); asleep the ATmega328P draws well under 1mA. On
+// battery-powered units that sit idle most of the day this is
+// most of the energy budget.
+//
+// IDLE SEQUENCE (see idleTask() in firmware.ino):
+//   scan stopped → park servo at SERVO_MIN_ANGLE → detach it
+//   → sleep → wake → stay awake IDLE_WAKE_WINDOW → sleep ...
+//
+// The servo parks at the sweep's start, so starting again is an
+// ordinary 1° step - no longer than any other.
+//
+// WAKE SOURCES:
+//   - Button (PCINT22, see Button.h): the press is queued by the
+//     ISR that woke us and handled on the next scheduler pass.
+//   - Serial RX (D0 = PCINT16): in SLEEP_MODE_PWR_DOWN the UART is
+//     off, so the byte that wakes the unit is lost. Send any byte
+//     first (e.g. a newline), then the command within the wake
+//     window. SLEEP_MODE_IDLE keeps the UART running and loses
+//     nothing, but saves far less.
+//
+// WHAT STOPS WHILE ASLEEP:
+//   - Timer1 (prescaler off; the servo is detached, no echo or
+//     DHT transaction in flight)
+//   - The ADC (not used, but enabled by the Arduino core)
+//   - Timer0's interrupt: millis() does not advance while asleep
+//     (in PWR_DOWN the timer stops anyway). Scheduler deadlines
+//     just run late.
+//
+// The board's USB chip, regulator and power LED are not affected;
+// a bare ATmega or a board without them sees the full saving.
+
+#ifndef POWER_H
+#define POWER_H
+
+#include "config.h"
+
+// Sleep until the button or serial RX wakes us. Returns at once if
+// a button event or received byte is already waiting (checked with
+// interrupts off, so neither can slip in before the sleep).
+// Waits for the TX buffer to drain first.
+void powerSleep();
+
+#endif
@@ -0,0 +1,99 @@
+// Profile.cpp
+// Per-stage timing statistics
+
+#include <Arduino.h>
+#include "Profile.h"
+#include "SerialPort.h"
+
+#if ENABLE_PROFILE
+
+struct StageStats {
+    uint16_t count;
+    unsigned long min;
+    unsigned long max;
+    unsigned long total;                // For the mean; reset each report
+    uint16_t buckets[PROFILE_BUCKETS];
+};
+
+static StageStats stats[PROFILE_STAGES];
+
+// LOG2 BUCKET:
+// Number of significant bits, so each bucket spans twice the
+// range of the previous one. A few shifts, no division.
+static uint8_t bucketFor(unsigned long us) {
+    uint8_t bucket = 0;
+    while (us != 0 && bucket < PROFILE_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void profileReset() {
+    memset(stats, 0, sizeof(stats));
+}
+
+void profileRecord(uint8_t stage, unsigned long us) {
+    StageStats* s = &stats[stage];
+
+    // After a reset everything is zero; min must start high
+    if (s->count == 0) {
+        s->min = 0xFFFFFFFFUL;
+    }
+    if (s->count == 0xFFFF) {
+        return;                         // Saturated until next report
+    }
+
+    s->count++;
+    s->total += us;
+    if (us < s->min) {
+        s->min = us;
+    }
+    if (us > s->max) {
+        s->max = us;
+    }
+
+    uint16_t* bucket = &s->buckets[bucketFor(us)];
+    if (*bucket != 0xFFFF) {
+        (*bucket)++;
+    }
+}
+
+static void printStageName(uint8_t stage) {
+    switch (stage) {
+        case PROFILE_STEP:    serialPort.print(F("step"));    break;
+        case PROFILE_SETTLE:  serialPort.print(F("settle"));  break;
+        case PROFILE_TRIGGER: serialPort.print(F("trigger")); break;
+        case PROFILE_ECHO:    serialPort.print(F("echo"));    break;
+        case PROFILE_ALERT:   serialPort.print(F("alert"));   break;
+        case PROFILE_OUTPUT:  serialPort.print(F("output"));  break;
+        case PROFILE_DHT:     serialPort.print(F("dht"));     break;
+        case PROFILE_EMIT:    serialPort.print(F("emit"));    break;
+        case PROFILE_UART:    serialPort.print(F("uart"));    break;
+    }
+}
+
+void profileReport() {
+    for (uint8_t i = 0; i < PROFILE_STAGES; i++) {
+        StageStats* s = &stats[i];
+
+        serialPort.print(F("PROFILE,"));
+        printStageName(i);
+        serialPort.print(',');
+        serialPort.print(s->count);
+        serialPort.print(',');
+        serialPort.print(s->count ? s->min : 0);
+        serialPort.print(',');
+        serialPort.print(s->count ? s->total / s->count : 0);
+        serialPort.print(',');
+        serialPort.print(s->max);
+        for (uint8_t b = 0; b < PROFILE_BUCKETS; b++) {
+            serialPort.print(',');
+            serialPort.print(s->buckets[b]);
+        }
+        serialPort.println();
+    }
+    profileReset();
+}
+
+#endif
@@ -0,0 +1,77 @@
+// Profile.h
+// On-Device Stage Profiler
+//
+// PURPOSE:
+// Shows where each scan step's time actually goes, so speed
+// changes can be proven on real hardware instead of with a
+// stopwatch. Only compiled in when ENABLE_PROFILE is 1.
+//
+// STAGES:
+//   step     MOVE to next MOVE (whole step period)
+//   settle   servo command until settle deadline reached
+//   trigger  startMeasurement() (trigger pulse + arming)
+//   echo     trigger until echo captured or timed out
+//   alert    Alert::updateMm()
+//   output   printData()
+//   dht      DHTSensor::read()
+//
+// LATENCY STAGES (one sample's path, timer1Micros()):
+//   echo     trigger → capture (the stage above)
+//   emit     capture → record queued for serial; includes the
+//            hold-back into the next settle (see PIPELINE in
+//            Scanner.h) and any delta/backpressure wait
+//   uart     queued → last byte loaded into UDR0 ("queued to
+//            UART"); the time the bytes ahead of it take to drain.
+//            It stops short of the wire: that byte still takes up to
+//            two character times (~174μs at 115200 baud) to shift
+//            out. One sample is probed at a time, so this is sampled
+//            rather than per sample.
+//
+// STATISTICS (per stage, in μs):
+//   count, min, mean, max, and a 16-bucket log2 histogram:
+//   bucket n counts durations in [2^(n-1), 2^n), bucket 0 is 0μs,
+//   bucket 15 collects everything ≥ 16384μs.
+//
+// REPORT FORMAT (text, one line per stage):
+//   PROFILE,<stage>,<count>,<min>,<mean>,<max>,<b0>,...,<b15>
+// Binary receivers skip these lines like any other text.
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "config.h"
+
+enum ProfileStage : uint8_t {
+    PROFILE_STEP,
+    PROFILE_SETTLE,
+    PROFILE_TRIGGER,
+    PROFILE_ECHO,
+    PROFILE_ALERT,
+    PROFILE_OUTPUT,
+    PROFILE_DHT,
+    PROFILE_EMIT,
+    PROFILE_UART,
+    PROFILE_STAGES
+};
+
+#define PROFILE_BUCKETS 16
+
+#if ENABLE_PROFILE
+
+void profileRecord(uint8_t stage, unsigned long us);
+void profileReport();       // Print all stages, then reset
+void profileReset();
+
+// Time a block within one function:
+//   PROFILE_START(t); work(); PROFILE_STOP(PROFILE_ALERT, t);
+#define PROFILE_START(t)        unsigned long t = micros()
+#define PROFILE_STOP(stage, t)  profileRecord(stage, micros() - (t))
+
+#else
+
+#define PROFILE_START(t)
+#define PROFILE_STOP(stage, t)
+
+#endif
+
+#endif
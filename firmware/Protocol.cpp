@@ -0,0 +1,113 @@
+// Protocol.cpp
+// Binary frame encoder
+
+#include <Arduino.h>
+#include "Protocol.h"
+#include "SerialPort.h"
+
+// Shared by all frame types so gaps show up regardless of type
+static uint8_t sequence = 0;
+
+// BITWISE CRC:
+// A 256-byte lookup table would be faster but costs flash or RAM.
+// With 5-6 bytes per frame the loop is only a few microseconds.
+uint8_t crc8(const uint8_t* data, uint8_t length) {
+    uint8_t crc = 0x00;
+    for (uint8_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+// FRAME ASSEMBLY:
+// Build the whole frame in a small buffer, then queue it in one
+// non-blocking tryWrite() call. If the TX buffer is full the frame
+// is dropped whole (counted by SerialPort); the sequence number
+// still advances so the receiver sees the gap.
+static void sendFrame(uint8_t* frame, uint8_t size) {
+    frame[0] = FRAME_SYNC;
+    frame[2] = sequence++;
+    frame[size - 1] = crc8(&frame[1], size - 2);
+    serialPort.tryWrite(frame, size);
+}
+
+void writeSampleFrame(uint8_t angle, uint16_t distanceMm, uint8_t quality) {
+    uint8_t frame[FRAME_SAMPLE_SIZE];
+    frame[1] = FRAME_SAMPLE;
+    frame[3] = angle;
+    frame[4] = distanceMm & 0xFF;
+    frame[5] = distanceMm >> 8;
+    frame[6] = quality;
+    sendFrame(frame, FRAME_SAMPLE_SIZE);
+}
+
+void writeEnvironmentFrame(uint8_t humidity, int16_t tempC10) {
+    uint8_t frame[FRAME_ENVIRONMENT_SIZE];
+    frame[1] = FRAME_ENVIRONMENT;
+    frame[3] = humidity;
+    frame[4] = (uint16_t)tempC10 & 0xFF;
+    frame[5] = (uint16_t)tempC10 >> 8;
+    sendFrame(frame, FRAME_ENVIRONMENT_SIZE);
+}
+
+void writeSweepFrame(uint16_t sweep, uint8_t flags) {
+    uint8_t frame[FRAME_SWEEP_SIZE];
+    frame[1] = FRAME_SWEEP;
+    frame[3] = sweep & 0xFF;
+    frame[4] = sweep >> 8;
+    frame[5] = flags;
+    sendFrame(frame, FRAME_SWEEP_SIZE);
+}
+
+void writeSegmentFrame(uint8_t first, uint8_t last, uint16_t nearestMm, uint16_t meanMm) {
+    uint8_t frame[FRAME_SEGMENT_SIZE];
+    frame[1] = FRAME_SEGMENT;
+    frame[3] = first;
+    frame[4] = last;
+    frame[5] = nearestMm & 0xFF;
+    frame[6] = nearestMm >> 8;
+    frame[7] = meanMm & 0xFF;
+    frame[8] = meanMm >> 8;
+    sendFrame(frame, FRAME_SEGMENT_SIZE);
+}
+
+void writeRawFrame(uint8_t angle, uint8_t sensor, uint16_t ticks, uint32_t time, uint16_t scale) {
+    uint8_t frame[FRAME_RAW_SIZE];
+    frame[1] = FRAME_RAW;
+    frame[3] = angle;
+    frame[4] = sensor;
+    frame[5] = ticks & 0xFF;
+    frame[6] = ticks >> 8;
+    frame[7] = time & 0xFF;
+    frame[8] = (time >> 8) & 0xFF;
+    frame[9] = (time >> 16) & 0xFF;
+    frame[10] = time >> 24;
+    frame[11] = scale & 0xFF;
+    frame[12] = scale >> 8;
+    sendFrame(frame, FRAME_RAW_SIZE);
+}
+
+void writeTrackFrame(uint8_t angle, uint16_t distanceMm, uint8_t quality, int16_t velocity) {
+    uint8_t frame[FRAME_TRACK_SIZE];
+    frame[1] = FRAME_TRACK;
+    frame[3] = angle;
+    frame[4] = distanceMm & 0xFF;
+    frame[5] = distanceMm >> 8;
+    frame[6] = quality;
+    frame[7] = (uint16_t)velocity & 0xFF;
+    frame[8] = (uint16_t)velocity >> 8;
+    sendFrame(frame, FRAME_TRACK_SIZE);
+}
+
+void writeTimeFrame(uint32_t time) {
+    uint8_t frame[FRAME_TIME_SIZE];
+    frame[1] = FRAME_TIME;
+    frame[3] = time & 0xFF;
+    frame[4] = (time >> 8) & 0xFF;
+    frame[5] = (time >> 16) & 0xFF;
+    frame[6] = time >> 24;
+    sendFrame(frame, FRAME_TIME_SIZE);
+}
@@ -0,0 +1,134 @@
+// Protocol.h
+// Compact Binary Output Protocol
+//
+// PURPOSE:
+// Alternative to the CSV lines from Scanner::printData().
+// Float-to-ASCII is slow on an AVR (no FPU) and a CSV line is
+// 25-35 bytes. A binary sample frame is 8 bytes and needs no
+// formatting at all, so more steps per second fit through the link.
+//
+// FRAME LAYOUT:
+//   [SYNC][TYPE][SEQ][payload ...][CRC8]
+//
+//   SYNC  0xA5, marks the start of a frame
+//   TYPE  frame type (see below)
+//   SEQ   uint8 sequence number, +1 per frame of any type,
+//         so the receiver can count dropped frames
+//   CRC8  polynomial 0x07, init 0x00, over TYPE..payload
+//
+// All multi-byte fields are little-endian (native AVR order).
+//
+// FRAME TYPES:
+//   SAMPLE (0x01), 8 bytes total:
+//     angle     uint8   degrees
+//     distance  uint16  millimetres, 0xFFFF = no valid reading,
+//                       0xFFFE = nothing within the range gate
+//     quality   uint8   high nibble: pings taken,
+//                       low nibble: pings agreeing with distance
+//
+//   ENVIRONMENT (0x02), 7 bytes total:
+//     humidity  uint8   % RH
+//     tempC     int16   tenths of °C (°F is derived by the host)
+//   Sent only when the DHT11 delivers a new reading, not per sample.
+//
+//   SWEEP (0x03), 7 bytes total:
+//     sweep     uint16  sweep counter (wraps)
+//     flags     uint8   SWEEP_KEYFRAME, SWEEP_REVERSE
+//   Sent when a sweep (one direction) begins. In a keyframe sweep
+//   every angle is sent; otherwise only angles that changed.
+//   SWEEP_SEGMENTS: SEGMENT frames follow instead of samples.
+//
+//   SEGMENT (0x04), 10 bytes total:
+//     first     uint8   lowest angle of the object, degrees
+//     last      uint8   highest angle, degrees
+//     nearest   uint16  millimetres, minimum over the segment
+//     mean      uint16  millimetres, average over the segment
+//   One per object, sent as soon as its last angle is measured,
+//   so the segments of each sweep arrive between SWEEP frames.
+//   Angles with no echo or beyond the gate belong to no segment.
+//
+//   RAW (0x05), 14 bytes total - only with RAW_CAPTURE:
+//     angle     uint8   degrees the sensor was pointing
+//     sensor    uint8   which HC-SR04 (0...SENSOR_COUNT-1)
+//     ticks     uint16  echo width in Timer1 ticks (0.5μs),
+//                       0 = no echo, 0xFFFF = beyond the range gate
+//     time      uint32  μs at the trigger, timer1Micros() (wraps)
+//     scale     uint16  Q16 ticks-to-mm factor at the time
+//   One per ping, before the sample it contributes to. Every
+//   repeat ping (PINGS_PER_ANGLE) gets its own.
+//
+//   TRACK (0x06), 10 bytes total - only with ENABLE_TRACKING:
+//     angle     uint8   degrees
+//     distance  uint16  filtered millimetres, same codes as SAMPLE
+//     quality   uint8   as SAMPLE
+//     velocity  int16   radial mm/s, negative = approaching,
+//                       0 when the angle has no track
+//   Sent in place of SAMPLE (see Tracker.h).
+//
+//   TIME (0x07), 8 bytes total - only with ENABLE_TIMESTAMPS:
+//     time      uint32  μs at the trigger of the sample that follows,
+//                       timer1Micros() (wraps after 71 minutes)
+//   Sent immediately before each SAMPLE or TRACK frame, and only
+//   together with it. A prefix rather than more SAMPLE/TRACK
+//   variants; a receiver that ignores it loses nothing else.
+//
+// RESYNC:
+// A receiver that loses its place scans for SYNC and accepts a
+// frame only if the CRC matches. Text lines (boot banner, status
+// messages) are skipped the same way.
+//
+// This header has no Arduino dependencies so host tools can
+// include it to share the wire constants.
+
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stdint.h>
+
+#define FRAME_SYNC 0xA5
+
+#define FRAME_SAMPLE      0x01
+#define FRAME_ENVIRONMENT 0x02
+#define FRAME_SWEEP       0x03
+#define FRAME_SEGMENT     0x04
+#define FRAME_RAW         0x05
+#define FRAME_TRACK       0x06
+#define FRAME_TIME        0x07
+
+// Total frame sizes including SYNC and CRC
+#define FRAME_SAMPLE_SIZE      8
+#define FRAME_ENVIRONMENT_SIZE 7
+#define FRAME_SWEEP_SIZE       7
+#define FRAME_SEGMENT_SIZE     10
+#define FRAME_RAW_SIZE         14
+#define FRAME_TRACK_SIZE       10
+#define FRAME_TIME_SIZE        8
+
+// SWEEP frame flags
+#define SWEEP_KEYFRAME 0x01     // All angles follow
+#define SWEEP_REVERSE  0x02     // Angles decreasing (170° → 10°)
+#define SWEEP_SEGMENTS 0x04     // SEGMENT frames instead of SAMPLE frames
+
+// Distance field value for "no valid reading" (sensor returned -1)
+#define FRAME_DISTANCE_NONE 0xFFFF
+
+// Distance field value for "beyond the range gate" (sensor returned -2)
+#define FRAME_DISTANCE_BEYOND 0xFFFE
+
+// RAW frame ticks values (same as ECHO_TICKS_* in Ultrasonic.h)
+#define FRAME_TICKS_NONE   0x0000
+#define FRAME_TICKS_BEYOND 0xFFFF
+
+// CRC-8, polynomial 0x07 (x^8 + x^2 + x + 1), init 0x00
+uint8_t crc8(const uint8_t* data, uint8_t length);
+
+// Frame writers (queue on serialPort, dropped if no room)
+void writeSampleFrame(uint8_t angle, uint16_t distanceMm, uint8_t quality);
+void writeEnvironmentFrame(uint8_t humidity, int16_t tempC10);
+void writeSweepFrame(uint16_t sweep, uint8_t flags);
+void writeSegmentFrame(uint8_t first, uint8_t last, uint16_t nearestMm, uint16_t meanMm);
+void writeRawFrame(uint8_t angle, uint8_t sensor, uint16_t ticks, uint32_t time, uint16_t scale);
+void writeTrackFrame(uint8_t angle, uint16_t distanceMm, uint8_t quality, int16_t velocity);
+void writeTimeFrame(uint32_t time);
+
+#endif
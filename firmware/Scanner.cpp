@@ -4,96 +4,946 @@
 #include <Arduino.h>
 #include "Servo.h"
 #include "Scanner.h"
+#include "Profile.h"
+#include "Protocol.h"
+#include "SerialPort.h"
+#include "SpeedOfSound.h"
+#include "Timer1.h"
 #include "config.h"
 
 // DEPENDENCY INJECTION:
 // Scanner doesn't create its own components - they're passed in.
 // This allows the main program to control initialization order
-// and makes unit testing possible (you could pass mock objects).
-Scanner::Scanner(Ultrasonic* ultra, ServoMotor* srv, Alert* alrt, Button* btn) {
-    ultrasonic = ultra;
+// and lets the host build pass simulated ones (see Hal.h).
+Scanner::Scanner(RangeSensor* ultra, SweepServo* srv, ProximityAlert* alrt) {
+    sensors[0] = ultra;
+    for (uint8_t n = 1; n < SENSOR_COUNT; n++) {
+        sensors[n] = NULL;
+    }
     servo = srv;
     alert = alrt;
-    button = btn;
+    outputFormat = OUTPUT_FORMAT;
+    state = SCAN_IDLE;
+    sweepMin = SERVO_MIN_ANGLE;
+    sweepMax = SCAN_MAX_ANGLE;
+    fineStep = SERVO_STEP;
+    coarseStep = ADAPTIVE_COARSE_STEP;
+    passMin = sweepMin;
+    passMax = sweepMax;
+    angle = SERVO_MIN_ANGLE;
+    step = SERVO_STEP;
+    sensor = 0;
+    deadline = 0;
+    distance = DISTANCE_MM_INVALID;
+    for (uint8_t n = 0; n < SENSOR_COUNT; n++) {
+        ranges[n] = DISTANCE_MM_INVALID;
+    }
+    quality = 0;
+    velocity = 0;
+    outputPending = false;
+    outputAngle = SERVO_MIN_ANGLE;
+    pingCount = 0;
+    pingTime = 0;
+    for (uint8_t n = 0; n < SENSOR_COUNT; n++) {
+        echoEnd[n] = -(unsigned long)PING_QUIET_TIME;  // No wait for the first ping
+    }
+    triggerMicros = 0;
+    rawCapture = RAW_CAPTURE;
+    environment.valid = false;
+    distanceScale = DEFAULT_DISTANCE_SCALE;
+    rangeGate = RANGE_GATE;
+    sweepCount = 0;
+    keyframe = true;
+    skippedSamples = 0;
+#if ENABLE_PROFILE
+    captureMicros = 0;
+#endif
+#if ENABLE_ADAPTIVE_SWEEP
+    memset(hits, 0, sizeof(hits));
+    lastNear = false;
+    lastStride = fineStep;
+#endif
+#if ENABLE_SEGMENT_OUTPUT
+    for (uint8_t n = 0; n < SENSOR_COUNT; n++) {
+        segments[n].count = 0;
+    }
+#endif
+#if ENABLE_TRACKING
+    tracker.reset();
+    for (uint8_t n = 0; n < SENSOR_COUNT; n++) {
+        arrivals[n] = ARRIVAL_NONE;
+    }
+#endif
+#if ENABLE_PRIORITY_SECTORS
+    for (uint8_t i = 0; i <= PRIORITY_SECTORS; i++) {
+        sectors[i].first = SECTOR_NONE;
+    }
+    autoSector = false;
+    visiting = -1;
+    swingMargin = 0;
+#endif
+}
+
+void Scanner::setSensor(uint8_t index, RangeSensor* ultra) {
+    if (index < SENSOR_COUNT) {
+        sensors[index] = ultra;
+    }
+}
+
+void Scanner::setEnvironment(THReading* envData, uint16_t scale) {
+    environment = *envData;
+    if (scale != distanceScale) {
+        distanceScale = scale;
+        applyRangeGate();       // Same mm, different ticks
+    }
+}
+
+void Scanner::setRangeGate(uint16_t gateMm) {
+    rangeGate = gateMm;
+    applyRangeGate();
+}
+
+void Scanner::applyRangeGate() {
+    for (uint8_t n = 0; n < SENSOR_COUNT; n++) {
+        if (sensors[n]) {
+            sensors[n]->setRangeGate(rangeGate, distanceScale);
+        }
+    }
+}
+
+// LIVE RESIZE:
+// Takes effect from the next step. The angle under way may lie
+// outside a narrowed range; advance() then clamps to the nearer
+// end and reverses there, as at any other end of a sweep.
+void Scanner::setSweep(int minAngle, int maxAngle, int stepDegrees) {
+    sweepMin = minAngle;
+    sweepMax = maxAngle;
+    fineStep = stepDegrees;
+    coarseStep = stepDegrees > ADAPTIVE_COARSE_STEP ? stepDegrees : ADAPTIVE_COARSE_STEP;
+    step = step > 0 ? fineStep : -fineStep;
+#if ENABLE_PRIORITY_SECTORS
+    if (visiting >= 0) {
+        return;                 // The sweep picks them up when it resumes
+    }
+#endif
+    passMin = sweepMin;
+    passMax = sweepMax;
+}
+
+#if ENABLE_PRIORITY_SECTORS
+// A sector being swept finishes its pass over the old angles
+void Scanner::setSector(uint8_t index, uint8_t first, uint8_t last) {
+    if (index < PRIORITY_SECTORS) {
+        sectors[index].first = first;
+        sectors[index].last = last;
+    }
+}
+
+void Scanner::setAutoSector(bool enabled) {
+    autoSector = enabled;
+    if (!enabled) {
+        sectors[PRIORITY_SECTORS].first = SECTOR_NONE;
+    }
+}
+#endif
+
+void Scanner::setRawCapture(bool enabled) {
+    rawCapture = enabled;
+}
+
+void Scanner::setOutputFormat(uint8_t format) {
+    outputFormat = format;
+}
+
+uint8_t Scanner::getOutputFormat() {
+    return outputFormat;
+}
+
+uint16_t Scanner::getSkippedSamples() {
+    return skippedSamples;
+}
+
+void Scanner::printEnvironment(THReading* envData) {
+    if (outputFormat != OUTPUT_BINARY || !envData->valid) {
+        return;
+    }
+    writeEnvironmentFrame(envData->humidityRH, envData->temperatureC10);
 }
 
 // OUTPUT FORMAT:
-// CSV with 5 fields per line, no header row.
+// CSV with 5 fields per line, no header row; each sweep starts
+// with a SWEEP line (see SWEEP MARKER).
 // This format is easy to parse in Processing, Python, or any
 // serial monitor that supports CSV logging.
-void Scanner::printData(int angle, float distance, THReading* envData) {
-    Serial.print(angle);
-    Serial.print(",");
-    Serial.print(distance);
-    Serial.print(",");
+//
+// Distance is printed in cm with one decimal (mm resolution)
+// using integer math, -1 when there is no valid reading, or -2
+// when nothing was found within the range gate.
+//
+// In binary mode the same sample is one SAMPLE frame instead,
+// with distance in whole millimetres - or a TRACK frame, which
+// adds the velocity. Environment data goes out separately via
+// printEnvironment().
+//
+// ENABLE_TIMESTAMPS appends the trigger time (timer1Micros()) as
+// a sixth CSV column, or sends it as a TIME frame just before the
+// sample's frame in binary mode.
+void Scanner::printData(int angle, uint16_t distanceMm, uint8_t quality, THReading* envData) {
+    if (outputFormat == OUTPUT_BINARY) {
+#if ENABLE_TIMESTAMPS
+        writeTimeFrame(triggerMicros);
+#endif
+        // INVALID/BEYOND == FRAME_DISTANCE_*
+#if ENABLE_TRACKING
+        writeTrackFrame(angle, distanceMm, quality, velocity);
+#else
+        writeSampleFrame(angle, distanceMm, quality);
+#endif
+        return;
+    }
+
+    serialPort.print(angle);
+    serialPort.print(",");
+    if (distanceMm == DISTANCE_MM_INVALID) {
+        serialPort.print(-1);
+    } else if (distanceMm == DISTANCE_MM_BEYOND) {
+        serialPort.print(-2);
+    } else {
+        serialPort.print(distanceMm / 10);
+        serialPort.print(".");
+        serialPort.print(distanceMm % 10);
+    }
+    serialPort.print(",");
     if (envData->valid) {
-        Serial.print(envData->humidity);
-        Serial.print(",");
-        Serial.print(envData->temperatureC);
-        Serial.print(",");
-        Serial.println(envData->temperatureF);
+        serialPort.print(envData->humidity);
+        serialPort.print(",");
+        serialPort.print(envData->temperatureC);
+        serialPort.print(",");
+        serialPort.print(envData->temperatureF);
+    } else {
+        serialPort.print(",,");
+    }
+#if ENABLE_TIMESTAMPS
+    serialPort.print(",");
+    serialPort.print(triggerMicros);
+#endif
+    serialPort.println();
+}
+
+void Scanner::start() {
+    // Forward sweep first: 10° → 170°, then back
+    angle = sweepMin;
+    step = fineStep;
+    passMin = sweepMin;
+    passMax = sweepMax;
+    distance = DISTANCE_MM_INVALID;
+    for (uint8_t n = 0; n < SENSOR_COUNT; n++) {
+        ranges[n] = DISTANCE_MM_INVALID;
+    }
+    outputPending = false;              // Dropped by stop()
+    state = SCAN_MOVE;
+#if ENABLE_PROFILE
+    stepStart = 0;              // No step period for the first move
+#endif
+#if ENABLE_ADAPTIVE_SWEEP
+    lastNear = false;
+    lastStride = fineStep;
+#endif
+#if ENABLE_SEGMENT_OUTPUT
+    for (uint8_t n = 0; n < SENSOR_COUNT; n++) {
+        segments[n].count = 0;          // Drop any left by stop()
+    }
+#endif
+#if ENABLE_PRIORITY_SECTORS
+    visiting = -1;
+    travelled = 0;
+    swingMargin = 0;
+    detectionMm = DISTANCE_MM_INVALID;
+    sectors[PRIORITY_SECTORS].first = SECTOR_NONE;  // Placed by the first sweep
+#endif
+#if ENABLE_TRACKING
+    // Tracks from before a pause would mostly be stale anyway
+    tracker.reset();
+    for (uint8_t n = 0; n < SENSOR_COUNT; n++) {
+        arrivals[n] = ARRIVAL_NONE;
+    }
+#endif
+    printEnvironment(&environment);     // Binary: receiver starts with current env
+    applyRangeGate();                   // All sensors are set by now
+
+    // First sweep after a start is always a keyframe
+    sweepCount = 0xFFFF;                // beginSweep() wraps it to 0
+    beginSweep();
+}
+
+void Scanner::stop() {
+    for (uint8_t n = 0; n < SENSOR_COUNT; n++) {
+        sensors[n]->cancel();   // In case an echo is in flight
+    }
+    alert->stop();
+    state = SCAN_IDLE;
+}
+
+bool Scanner::isScanning() {
+    return state != SCAN_IDLE;
+}
+
+ScanState Scanner::getState() {
+    return state;
+}
+
+uint16_t Scanner::getSweepCount() {
+    return sweepCount;
+}
+
+// BIDIRECTIONAL SWEEP:
+// Instead of always starting at 0, we alternate directions.
+// Forward:  passMin → passMax (step > 0)
+// Backward: passMax → passMin (step < 0)
+// (SERVO_MIN_ANGLE and SCAN_MAX_ANGLE unless setSweep() narrowed
+// them or a sector is being swept; SCAN_MAX_ANGLE is
+// SERVO_MAX_ANGLE with a single sensor)
+// A stride that overshoots stops at the end angle first, so the
+// ends are always measured. The end angle is then measured once
+// more as the first sample of the reverse sweep, as before.
+//
+// Only the end the sweep is heading for reverses it. Leaving the
+// pass at the other end - a backtrack, or an angle the range has
+// been narrowed past (setSweep() mid-sweep) - clamps to it and
+// carries on in the same direction, within the same sweep.
+bool Scanner::advance(int stride) {
+    int next = angle + stride;
+    bool reversed = false;
+
+    if (next > passMax) {
+        if (step > 0 && angle >= passMax) {
+            step = -fineStep;
+            reversed = true;
+        }
+        next = passMax;
+    } else if (next < passMin) {
+        if (step < 0 && angle <= passMin) {
+            step = fineStep;
+            reversed = true;
+        }
+        next = passMin;
+    }
+
+#if ENABLE_ADAPTIVE_SWEEP
+    lastStride = abs(next - angle);
+#endif
+    angle = next;
+    return reversed;
+}
+
+#if ENABLE_ADAPTIVE_SWEEP
+bool Scanner::isHit(int angle) {
+    uint8_t i = angle - SERVO_MIN_ANGLE;
+    return hits[i >> 3] & (1 << (i & 7));
+}
+
+void Scanner::setHit(int angle, bool hit) {
+    uint8_t i = angle - SERVO_MIN_ANGLE;
+    if (hit) {
+        hits[i >> 3] |= (1 << (i & 7));
+    } else {
+        hits[i >> 3] &= ~(1 << (i & 7));
+    }
+}
+#endif
+
+// PING AGREEMENT:
+// Two timeouts agree (nothing there); a timeout and an echo don't.
+// BEYOND compares as a very large distance: two agree, and it
+// never agrees with a real echo.
+static bool pingsAgree(uint16_t a, uint16_t b) {
+    if (a == b) {
+        return true;
+    }
+    if (a == DISTANCE_MM_INVALID || b == DISTANCE_MM_INVALID) {
+        return false;
+    }
+    uint16_t delta = a > b ? a - b : b - a;
+    return delta <= PING_AGREEMENT;
+}
+
+// Insert into the sorted ping list. In sorted order the closest
+// values are neighbours, so only those need checking.
+// INVALID (0xFFFF) sorts last, which keeps the median honest:
+// mostly timeouts → median is a timeout.
+// Single-ping builds fold the sorting and agreement checks away
+// (and never index past pings[0]).
+bool Scanner::recordPing(uint16_t distanceMm) {
+    uint8_t i = pingCount++;
+    while (PINGS_PER_ANGLE > 1 && i > 0 && pings[i - 1] > distanceMm) {
+        pings[i] = pings[i - 1];
+        i--;
+    }
+    pings[i] = distanceMm;
+
+    bool agreed = PINGS_PER_ANGLE > 1 &&
+                  ((i > 0 && pingsAgree(pings[i - 1], distanceMm)) ||
+                   (i + 1 < pingCount && pingsAgree(distanceMm, pings[i + 1])));
+
+    return agreed || pingCount >= PINGS_PER_ANGLE;
+}
+
+// MEDIAN:
+// Lower median for even counts - with two agreeing pings that is
+// simply the nearer one.
+void Scanner::resolvePings() {
+    distance = pings[(pingCount - 1) / 2];
+
+    uint8_t agreeing = 0;
+    for (uint8_t i = 0; i < pingCount; i++) {
+        if (pingsAgree(pings[i], distance)) {
+            agreeing++;
+        }
+    }
+    quality = (pingCount << 4) | agreeing;
+}
+
+// STEP PLANNING:
+// Decides how far to move after the sample just taken.
+// Without ENABLE_ADAPTIVE_SWEEP this is always the fine step.
+// With several sensors, "near" means any of them saw an echo.
+int Scanner::nextStride() {
+#if ENABLE_ADAPTIVE_SWEEP
+    bool near = false;
+    for (uint8_t n = 0; n < SENSOR_COUNT; n++) {
+        bool hit = ranges[n] != DISTANCE_MM_INVALID && ranges[n] <= ADAPTIVE_RANGE;
+        setHit(angle + n * SENSOR_SPACING, hit);
+        near = near || hit;
+    }
+
+    bool wasNear = lastNear;
+    lastNear = near;
+
+    // Keyframes are full resolution; this also refreshes hits[]
+    if (keyframe) {
+        return step;
+    }
+
+    if (near) {
+        // RISING EDGE FOUND BY A COARSE STEP:
+        // The edge is somewhere between the previous sample and
+        // this one. Go back to just past the previous sample.
+        if (!wasNear && lastStride > fineStep) {
+            return (step > 0 ? -1 : 1) * (lastStride - fineStep);
+        }
+        return step;
+    }
+
+    // LOOK AHEAD:
+    // Slow down early if the previous sweep saw an echo anywhere
+    // in the span a coarse step would skip.
+    for (int i = 1; i <= coarseStep; i++) {
+        int ahead = angle + (step > 0 ? i : -i);
+        if (ahead < passMin || ahead > passMax) {
+            break;
+        }
+        for (uint8_t n = 0; n < SENSOR_COUNT; n++) {
+            if (isHit(ahead + n * SENSOR_SPACING)) {
+                return step;
+            }
+        }
+    }
+    return (step > 0 ? 1 : -1) * coarseStep;
+#else
+    return step;
+#endif
+}
+
+#if ENABLE_PRIORITY_SECTORS
+// WEIGHTED ROUND-ROBIN (see PRIORITY SECTORS in Scanner.h):
+// Called after every advance(). A sector pass ends where advance()
+// would reverse it; the next set sector follows, or the sweep
+// resumes. Only the sweep itself reverses into a new sweep.
+bool Scanner::scheduleSectors(int moved, bool reversed) {
+    if (visiting >= 0) {
+        if (reversed && !visitSector(visiting + 1)) {
+            visiting = -1;
+            passMin = sweepMin;
+            passMax = sweepMax;
+            jumpTo(resumeAngle, resumeForward);
+        }
+        return false;
+    }
+
+    if (reversed) {
+        updateAutoSector();
+        return true;
+    }
+    travelled += moved;
+    if (travelled >= PRIORITY_CHUNK) {
+        travelled = 0;
+        resumeAngle = angle;            // Not measured yet
+        resumeForward = step > 0;
+        visitSector(0);
+    }
+    return false;
+}
+
+// Sweep the sector from its nearer end
+bool Scanner::visitSector(uint8_t from) {
+    for (uint8_t i = from; i <= PRIORITY_SECTORS; i++) {
+        if (sectors[i].first == SECTOR_NONE) {
+            continue;
+        }
+        int first = sectors[i].first;
+        int last = sectors[i].last;
+        bool forward = abs(angle - first) <= abs(angle - last);
+        visiting = i;
+        passMin = first;
+        passMax = last;
+        jumpTo(forward ? first : last, forward);
+        return true;
+    }
+    return false;
+}
+
+// A jump is not a step: no backtrack across it, and no segment
+// joining angles that aren't neighbours
+void Scanner::jumpTo(int target, bool forward) {
+    swingMargin = (unsigned long)abs(target - angle) * PRIORITY_SWING_MARGIN;
+    angle = target;
+    step = forward ? fineStep : -fineStep;
+#if ENABLE_ADAPTIVE_SWEEP
+    lastNear = false;
+    lastStride = fineStep;
+#endif
+#if ENABLE_SEGMENT_OUTPUT
+    if (segmentOutput()) {
+        closeSegments();
+    }
+#endif
+}
+
+// AUTOMATIC SECTOR:
+// Around the nearest echo of the sweep just ended, clipped to the
+// sweep range
+void Scanner::updateAutoSector() {
+    Sector* sector = &sectors[PRIORITY_SECTORS];
+    if (autoSector && detectionMm != DISTANCE_MM_INVALID) {
+        int first = detectionAngle - PRIORITY_AUTO_MARGIN;
+        int last = detectionAngle + PRIORITY_AUTO_MARGIN;
+        sector->first = first < sweepMin ? sweepMin : first;
+        sector->last = last > sweepMax ? sweepMax : last;
     } else {
-        Serial.println(",,");
-    }
-}
-
-bool Scanner::scan(THReading* envData, float soundSpeed) {
-    // BIDIRECTIONAL SWEEP SETUP:
-    // Instead of always starting at 0, we alternate directions.
-    // angles[0]=0, steps[0]=+1   → sweep 0 to 180
-    // angles[1]=180, steps[1]=-1 → sweep 180 to 0
-    int angles[] = {SERVO_MIN_ANGLE, SERVO_MAX_ANGLE};
-    int steps[] = {1, -1};
-    
-    // Perform both sweeps (forward and backward)
-    for (int i = 0; i < 2; i++) {
-        int angle = angles[i];
-        int step = steps[i];
-        
-        // SWEEP LOOP:
-        // Continue while angle is within valid range
-        // Forward:  while angle <= SERVO_MAX_ANGLE
-        // Backward: while angle >= SERVO_MIN_ANGLE
-        while ((step > 0 && angle <= SERVO_MAX_ANGLE) || (step < 0 && angle >= SERVO_MIN_ANGLE)) {
-            
-            // CHECK FOR INTERRUPT:
-            // Allow user to stop mid-sweep by pressing button.
-            // Without this, user would have to wait up to 22 seconds
-            // for the sweep to complete.
-            if (button->isPressed()) {
-                alert->stop();
-                return false;   // Signal that scan was interrupted
+        sector->first = SECTOR_NONE;
+    }
+    detectionMm = DISTANCE_MM_INVALID;
+}
+#endif
+
+// Largest record printData() can produce
+// CSV: "170,400.0,90.00,50.00,122.00\r\n" is 30 bytes,
+// ",4294967295" adds 11 with timestamps
+#if ENABLE_TIMESTAMPS
+#define CSV_LINE_MAX 52
+#else
+#define CSV_LINE_MAX 40
+#endif
+
+#if ENABLE_TRACKING
+#define FRAME_RECORD_SIZE FRAME_TRACK_SIZE
+#else
+#define FRAME_RECORD_SIZE FRAME_SAMPLE_SIZE
+#endif
+
+#if ENABLE_TIMESTAMPS
+#define SAMPLE_RECORD_SIZE (FRAME_TIME_SIZE + FRAME_RECORD_SIZE)
+#else
+#define SAMPLE_RECORD_SIZE FRAME_RECORD_SIZE
+#endif
+
+bool Scanner::outputHasRoom() {
+    uint8_t needed = outputFormat == OUTPUT_BINARY ? SAMPLE_RECORD_SIZE : CSV_LINE_MAX;
+    if (serialPort.availableForWrite() >= needed) {
+        return true;
+    }
+    skippedSamples++;
+    return false;
+}
+
+// Nearest of the latest per-sensor readings (INVALID sorts last)
+uint16_t Scanner::nearestRange() {
+    uint16_t nearest = ranges[0];
+    for (uint8_t n = 1; n < SENSOR_COUNT; n++) {
+        if (ranges[n] < nearest) {
+            nearest = ranges[n];
+        }
+    }
+    return nearest;
+}
+
+#if ENABLE_TRACKING
+// Soonest arrival of the latest per-sensor readings
+uint16_t Scanner::nearestArrival() {
+    uint16_t soonest = arrivals[0];
+    for (uint8_t n = 1; n < SENSOR_COUNT; n++) {
+        if (arrivals[n] < soonest) {
+            soonest = arrivals[n];
+        }
+    }
+    return soonest;
+}
+#endif
+
+// SWEEP MARKER:
+// Tells a binary receiver where each sweep starts and whether
+// every angle will follow (keyframe) or only changed ones.
+//
+// CSV gets a "SWEEP,<count>,<F|R>" line instead. The angles
+// alone cannot show it: adaptive steps and priority sectors
+// step back and jump within a sweep, so a receiver that split
+// on a change of direction would split one sweep into several.
+// Like other status text, it is written blocking - it must not
+// be dropped the way a sample may be.
+void Scanner::beginSweep() {
+    sweepCount++;
+    keyframe = (sweepCount % KEYFRAME_INTERVAL) == 0;
+
+    if (outputFormat == OUTPUT_CSV) {
+        serialPort.print(F("SWEEP,"));
+        serialPort.print(sweepCount);
+        serialPort.println(step < 0 ? F(",R") : F(",F"));
+    } else {
+        uint8_t flags = 0;
+        if (keyframe) {
+            flags |= SWEEP_KEYFRAME;
+        }
+        if (step < 0) {
+            flags |= SWEEP_REVERSE;
+        }
+        if (segmentOutput()) {
+            flags |= SWEEP_SEGMENTS;
+        }
+        writeSweepFrame(sweepCount, flags);
+    }
+}
+
+bool Scanner::segmentOutput() {
+    return ENABLE_SEGMENT_OUTPUT && outputFormat == OUTPUT_BINARY;
+}
+
+#if ENABLE_SEGMENT_OUTPUT
+// SEGMENTATION:
+// Neighbouring samples are compared with each other, not with the
+// segment's mean, so a wall seen at a slant stays one segment.
+// No echo and beyond-gate readings are gaps.
+void Scanner::addSegmentSample(uint8_t n, int angle, uint16_t distanceMm) {
+    Segment* segment = &segments[n];
+    bool echo = distanceMm != DISTANCE_MM_INVALID && distanceMm != DISTANCE_MM_BEYOND;
+
+    if (segment->count > 0) {
+        uint16_t delta = distanceMm > segment->previous ? distanceMm - segment->previous
+                                                        : segment->previous - distanceMm;
+        if (echo && delta <= SEGMENT_GAP) {
+            segment->last = angle;
+            segment->previous = distanceMm;
+            if (distanceMm < segment->nearest) {
+                segment->nearest = distanceMm;
+            }
+            segment->sum += distanceMm;
+            segment->count++;
+            return;
+        }
+        closeSegment(n);
+    }
+
+    if (echo) {
+        segment->first = angle;
+        segment->last = angle;
+        segment->nearest = distanceMm;
+        segment->previous = distanceMm;
+        segment->sum = distanceMm;
+        segment->count = 1;
+    }
+}
+
+// Angles go out lowest first whatever the sweep direction
+void Scanner::closeSegment(uint8_t n) {
+    Segment* segment = &segments[n];
+    if (segment->count == 0) {
+        return;
+    }
+    uint8_t low = segment->first < segment->last ? segment->first : segment->last;
+    uint8_t high = segment->first < segment->last ? segment->last : segment->first;
+    PROFILE_START(t);
+    writeSegmentFrame(low, high, segment->nearest, segment->sum / segment->count);
+    PROFILE_STOP(PROFILE_OUTPUT, t);
+    segment->count = 0;
+}
+
+void Scanner::closeSegments() {
+    for (uint8_t n = 0; n < SENSOR_COUNT; n++) {
+        closeSegment(n);
+    }
+}
+#endif
+
+// DELTA FILTER:
+// Compare against the value last *sent* (not last measured), so
+// slow drift still gets through once it exceeds the deadband.
+// Changes between valid and invalid always count.
+bool Scanner::shouldSend(int angle, uint16_t distanceMm) {
+#if ENABLE_DELTA_OUTPUT
+    uint16_t* last = &frame[angle - SERVO_MIN_ANGLE];
+
+    if (!keyframe && distanceMm == *last) {
+        return false;
+    }
+    if (!keyframe && distanceMm != DISTANCE_MM_INVALID && *last != DISTANCE_MM_INVALID) {
+        uint16_t delta = distanceMm > *last ? distanceMm - *last : *last - distanceMm;
+        if (delta <= DELTA_DEADBAND) {
+            return false;
+        }
+    }
+
+    *last = distanceMm;
+    return true;
+#else
+    (void)angle;
+    (void)distanceMm;
+    return true;
+#endif
+}
+
+// SEND DATA:
+// Transmit measurement immediately for real-time display,
+// unless it matches what the receiver already has.
+//
+// BACKPRESSURE:
+// If the TX buffer can't take a whole record, skip it
+// rather than stall the sweep. The frame buffer is left
+// untouched, so with delta output the skipped angle is
+// simply sent on a later sweep (coalesced).
+//
+// Segment output sends nothing per sample (see SEGMENT OUTPUT).
+//
+// LATENCY (ENABLE_PROFILE):
+// emit is capture → queued for every sample sent; uart (queued to
+// UART) is sampled, one probe at a time: each finished probe is
+// collected here and a new one started behind the record just
+// queued.
+//
+// UPDATE ALERT:
+// Posts the nearest reading; Alert's timer produces the
+// pattern itself and ignores repeats of the same distance.
+void Scanner::emitSample(int pointing) {
+    if (!segmentOutput()) {
+        if (outputHasRoom() && shouldSend(pointing, distance)) {
+            PROFILE_START(t);
+            printData(pointing, distance, quality, &environment);
+            PROFILE_STOP(PROFILE_OUTPUT, t);
+#if ENABLE_PROFILE
+            profileRecord(PROFILE_EMIT, timer1Micros() - captureMicros);
+            uint32_t queued;
+            if (serialPort.txProbeDone(&queued)) {
+                profileRecord(PROFILE_UART, queued);
             }
+            serialPort.txProbeStart();
+#endif
+        }
+    }
+
+    PROFILE_START(t);
+#if ENABLE_TRACKING
+    alert->updateApproach(nearestRange(), nearestArrival());
+#else
+    alert->updateMm(nearestRange());
+#endif
+    PROFILE_STOP(PROFILE_ALERT, t);
+}
+
+// Sample held back to overlap the move (see PIPELINE)
+void Scanner::flushOutput() {
+    if (outputPending) {
+        outputPending = false;
+        emitSample(outputAngle);
+    }
+}
+
+// COMMAND THE MOVE:
+// Position the sensor at current angle. The servo's
+// settle model says when it will be there - short for
+// 1° steps, longer for coarse steps (see Servo.h).
+void Scanner::beginMove() {
+    deadline = servo->moveTo(angle);
+#if ENABLE_PRIORITY_SECTORS
+    deadline += swingMargin;
+    swingMargin = 0;
+#endif
+    sensor = 0;
+    pingCount = 0;
+    state = SCAN_SETTLE;
+#if ENABLE_PROFILE
+    stageStart = micros();
+    if (stepStart != 0) {
+        profileRecord(PROFILE_STEP, stageStart - stepStart);
+    }
+    stepStart = stageStart;
+#endif
+}
+
+void Scanner::tick() {
+    if (state == SCAN_IDLE) {
+        return;
+    }
+
+    switch (state) {
+        case SCAN_MOVE:
+            // First move after start(); later ones come from EMIT
+            beginMove();
+            break;
+
+        case SCAN_SETTLE:
+            // Previous angle's output goes out while the servo
+            // travels - one tick of its own, then back to waiting
+            if (outputPending) {
+                flushOutput();
+                break;
+            }
+
+            // Wait for servo to reach position - without blocking.
+            // Signed difference handles micros() rollover.
+            if ((long)(micros() - deadline) >= 0) {
+                state = SCAN_TRIGGER;
+#if ENABLE_PROFILE
+                profileRecord(PROFILE_SETTLE, micros() - stageStart);
+#endif
+            }
+            break;
+
+        case SCAN_TRIGGER:
+            // PING SPACING:
+            // Give this sensor's previous ping time to die out -
+            // at a new angle too, where late echoes from the last
+            // one would otherwise read as this angle's distance.
+            // Counted from the end of its echo, so a near echo is
+            // not held to a miss's worst case (see PING_QUIET_TIME).
+            if (millis() - echoEnd[sensor] < PING_QUIET_TIME) {
+                break;
+            }
+#if SENSOR_COUNT > 1
+            // STAGGER:
+            // Next sensor waits out the previous sensor's ping
+            // (pingTime was reset when its echo came in).
+            if (pingCount == 0 && sensor > 0 && millis() - pingTime < SENSOR_STAGGER) {
+                break;
+            }
+#endif
 
-            // MOVE SERVO:
-            // Position the sensor at current angle
-            servo->setAngle(angle);
-            delay(SERVO_DELAY);     // Wait for servo to reach position
-            
             // TAKE MEASUREMENT:
-            // Detach servo to free Timer1 for ultrasonic Input Capture
-            // See Servo.h for detailed explanation
-            servo->detach();             // cut PWM after move
-            delayMicroseconds(50);       // stabilization
-
-            float distance = ultrasonic->getDistance(soundSpeed);
-
-            servo->attach();
-            delay(5);
-            
-            // UPDATE ALERT:
-            // Check if object is within alert threshold and
-            // update LED/buzzer accordingly
-            alert->update(distance);
-
-            // SEND DATA:
-            // Transmit measurement immediately for real-time display
-            printData(angle, distance, envData);
-            
-            // NEXT STEP:
-            // Move to next angle (increment or decrement based on direction)
-            angle += step;
-        }
-    }
-    return true;    // Scan completed without interruption
-}
\ No newline at end of file
+            // The servo stays attached - it shares the free-running
+            // Timer1 with Input Capture (see Servo.h), so it keeps
+            // holding position while we measure.
+            {
+                PROFILE_START(t);
+                triggerMicros = timer1Micros();
+                sensors[sensor]->startMeasurement();
+                PROFILE_STOP(PROFILE_TRIGGER, t);
+            }
+            pingTime = millis();
+            state = SCAN_WAIT_ECHO;
+#if ENABLE_PROFILE
+            stageStart = micros();
+#endif
+            break;
+
+        case SCAN_WAIT_ECHO:
+            // ECHO IN FLIGHT:
+            // The capture ISR records the pulse in the background;
+            // other tasks run until it is in or timed out.
+            if (!sensors[sensor]->isReady()) {
+                break;
+            }
+            echoEnd[sensor] = millis();
+#if ENABLE_PROFILE
+            profileRecord(PROFILE_ECHO, micros() - stageStart);
+            captureMicros = timer1Micros();
+#endif
+            if (rawCapture && outputFormat == OUTPUT_BINARY) {
+                writeRawFrame(angle + sensor * SENSOR_SPACING, sensor,
+                              sensors[sensor]->resultTicks(), triggerMicros, distanceScale);
+            }
+            if (recordPing(sensors[sensor]->resultMm(distanceScale))) {
+                resolvePings();
+#if ENABLE_TRACKING
+                // Timed at the last trigger - close enough at 64ms resolution
+                distance = tracker.update(angle + sensor * SENSOR_SPACING, distance, pingTime);
+                velocity = tracker.velocity();
+                arrivals[sensor] = tracker.arrivalMs();
+#endif
+                ranges[sensor] = distance;
+#if ENABLE_PRIORITY_SECTORS
+                // BEYOND and INVALID are both > PRIORITY_AUTO_RANGE
+                if (distance <= PRIORITY_AUTO_RANGE && distance < detectionMm) {
+                    detectionMm = distance;
+                    detectionAngle = angle;     // Servo angle, as sectors are
+                }
+#endif
+                state = SCAN_EMIT;
+            } else {
+                state = SCAN_TRIGGER;   // Another ping at this angle
+            }
+            break;
+
+        case SCAN_EMIT:
+            // NEXT SENSOR at the same servo angle, if any.
+            // The servo stays put, so there is nothing to overlap.
+            if (sensor + 1 < SENSOR_COUNT) {
+                emitSample(angle + sensor * SENSOR_SPACING);
+                sensor++;
+                pingCount = 0;
+                pingTime = millis();    // SENSOR_STAGGER counts from here
+                state = SCAN_TRIGGER;
+                break;
+            }
+
+            // PIPELINE:
+            // Last sensor at this angle. Plan and command the next
+            // move first; the sample is sent from SETTLE, while the
+            // servo is travelling. At the end of a sweep it goes out
+            // here instead, so it stays ahead of the SWEEP frame.
+            outputAngle = angle + sensor * SENSOR_SPACING;
+            outputPending = true;
+            {
+                int stride = nextStride();
+#if ENABLE_SEGMENT_OUTPUT
+                // A backtrack (stride against the sweep) will measure
+                // this angle again at full resolution - wait for that
+                if (segmentOutput() && (stride > 0) == (step > 0)) {
+                    for (uint8_t n = 0; n < SENSOR_COUNT; n++) {
+                        addSegmentSample(n, angle + n * SENSOR_SPACING, ranges[n]);
+                    }
+                }
+#endif
+#if ENABLE_PRIORITY_SECTORS
+                int from = angle;
+                bool reversed = advance(stride);
+                reversed = scheduleSectors(abs(angle - from), reversed);
+#else
+                bool reversed = advance(stride);
+#endif
+                if (reversed) {
+                    flushOutput();
+#if ENABLE_SEGMENT_OUTPUT
+                    if (segmentOutput()) {
+                        closeSegments();    // Before the next SWEEP frame
+                    }
+#endif
+#if ENABLE_PROFILE
+                    profileReport();        // One report per sweep
+#endif
+                    beginSweep();
+                }
+            }
+            beginMove();
+            break;
+
+        default:
+            break;
+    }
+}
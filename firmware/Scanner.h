@@ -15,16 +15,136 @@
 // Using 10-170 instead of 0-180 to avoid servo mechanical stops.
 // Cheap SG90 clones often can't reach full range without straining.
 //
+// STATE MACHINE:
+// The sweep no longer blocks in delay(). Each call to tick() does
+// one small step and returns, so the main loop can service the
+// button, DHT and alert in between:
+//
+//   MOVE → SETTLE → TRIGGER → WAIT_ECHO → EMIT → SETTLE ...
+//
+//   MOVE       command servo to the first angle, set deadline
+//   SETTLE     send the previous sample, then wait (without
+//              blocking) until the servo has arrived
+//   TRIGGER    fire the ultrasonic pulse
+//   WAIT_ECHO  poll the capture ISR until echo or timeout
+//   EMIT       plan and command the next move
+//
+// PIPELINE:
+// Output and alert for angle N run during angle N+1's settle
+// window instead of ahead of the move, so their cost hides
+// behind the servo's travel:
+//
+//   servo:      [ settle N ][ ping N ][ settle N+1 ][ ping N+1 ]
+//   CPU:                              [ out N ]
+//
+// Only the output that ends a sweep is sent before the move, to
+// keep it ahead of the next SWEEP frame.
+//
 // TIMING:
 // Each step takes approximately:
-//   60ms servo delay + 2ms trigger + up to 30ms echo
-//   ≈ 90-100ms per degree
-// Full sweep (322 steps): ~20 seconds
+//   servo settle (see Servo.h) + up to 35ms echo
+//   settle for 1°: ≤20ms pulse wait + 4ms + 1.7ms
+//
+// DELTA OUTPUT (ENABLE_DELTA_OUTPUT in config.h):
+// A frame buffer holds the last distance sent for each angle.
+// In a static scene most samples match it, so only angles that
+// moved by more than DELTA_DEADBAND are sent. Every
+// KEYFRAME_INTERVAL sweeps a full keyframe is sent instead.
+//
+// ADAPTIVE SWEEP (ENABLE_ADAPTIVE_SWEEP in config.h):
+// The 15° beam makes most 1° steps redundant in empty space.
+//   - Empty sample, no echo ahead last sweep → coarse step (5°)
+//   - Echo within ADAPTIVE_RANGE             → fine step (1°)
+//   - Coarse step lands on an echo           → backtrack to just
+//     past the previous sample and step fine to find the edge
+//
+//   angle:  10    15    20 21 22 23 24 25 26 27    32    37
+//   echo:    -     -     -  -  -  #  #  #  -   -     -     -
+//                        └─ backtrack from 25
+//
+// MULTI-PING (PINGS_PER_ANGLE in config.h):
+// TRIGGER ⇄ WAIT_ECHO repeats until two pings agree or the limit
+// is reached, each ping PING_QUIET_TIME after the last echo
+// ended (see Ultrasonic.h), as at a new angle. The median is
+// reported; the binary SAMPLE frame also carries how many pings
+// were taken and how many agree with it.
+//
+// MULTIPLE SENSORS (SENSOR_COUNT in config.h):
+// At each servo angle every sensor is pinged in turn, each through
+// its own TRIGGER ⇄ WAIT_ECHO → EMIT, and reported at the angle it
+// points at (servo angle + n × SENSOR_SPACING). The servo only
+// covers the first sensor's share of the range:
+//
+//   2 sensors, 80° apart:  servo 10° → 90°
+//                          sensor 0: 10° → 90°, sensor 1: 90° → 170°
+//
+// Samples within a sweep are therefore not in angle order; every
+// one carries its angle, so receivers index by angle as before.
+// The alert follows the nearest of the latest readings.
+//
+// PRIORITY SECTORS (ENABLE_PRIORITY_SECTORS in config.h):
+// A weighted round-robin between the sweep and a few sectors of
+// servo angles. The sweep gets PRIORITY_CHUNK degrees per turn,
+// each sector one pass (towards its far end from whichever end
+// is nearer), then the sweep resumes at the angle it left off:
+//
+//   sweep:   10 →→→ 40 ┐                  ┌ 41 →→→ 70 ┐
+//   sectors:           └ 90 → 110, 60 ← 75 ┘            └ ...
+//
+// A sector is seen every chunk + all sector passes + the swings,
+// instead of once per sweep; the sweep gets slower by the same
+// time. Sector passes send samples but no SWEEP frame: they fall
+// inside the sweep that is under way, out of angle order, as with
+// several sensors - receivers index by angle. Adaptive stepping
+// applies inside sectors too.
+//
+// The automatic sector (setAutoSector) is placed at the end of
+// each sweep around its nearest echo within PRIORITY_AUTO_RANGE,
+// and dropped when there was none.
+//
+// RANGE GATE (RANGE_GATE in config.h):
+// Sensors stop listening at the gate and report "beyond" (CSV -2,
+// binary 0xFFFE) instead of a distance. A beyond reading counts
+// as empty for the alert and adaptive sweep. The gate is passed
+// on again whenever the speed of sound changes.
+//
+// LIVE SETTINGS (serial commands, see Settings.h):
+// setSweep(), setRangeGate() and setOutputFormat() may be called
+// between ticks, mid-sweep; each takes effect from the next step.
+// Frame buffers stay indexed by the profile's full range, so a
+// narrower or coarser sweep only leaves some entries unused.
+//
+// SEGMENT OUTPUT (ENABLE_SEGMENT_OUTPUT in config.h, binary only):
+// Each sensor keeps one open segment. A sample within SEGMENT_GAP
+// of the previous one extends it; anything else closes it (one
+// SEGMENT frame) and may open the next. The end of a sweep closes
+// all of them. Samples an adaptive backtrack will measure again
+// are left out, so every angle counts once.
+//
+//   distance:  -  -  812 815 820  -  -  1490 1502  -
+//   segments:        [ 812..820 ]       [1490..1502]
+//
+// TRACKING (ENABLE_TRACKING in config.h):
+// Each sample is filtered against earlier sweeps at its angle
+// before anything else sees it (see Tracker.h), so output, delta
+// deadband, adaptive sweep, segments and alert all work on the
+// filtered range. The alert gets the soonest arrival of any
+// sensor's latest reading as well.
+//
+// RAW CAPTURE (RAW_CAPTURE in config.h, binary only):
+// Every ping is also sent as a RAW frame - echo ticks, trigger
+// time and scale - so a recording holds what the sensor saw, not
+// just what the filters made of it (see host/replay).
 //
 // OUTPUT FORMAT (CSV):
 // angle,distance,humidity,temperatureC,temperatureF
 // Each line is one measurement, sent as soon as taken.
 // This allows real-time visualization by the receiving software.
+// A SWEEP,<count>,<F|R> line marks the start of each sweep.
+//
+// OUTPUT FORMAT (BINARY):
+// One 8-byte SAMPLE frame per measurement, plus an ENVIRONMENT
+// frame whenever the DHT11 has a new reading (see Protocol.h).
 
 #ifndef SCANNER_H
 #define SCANNER_H
@@ -33,26 +153,203 @@
 #include "Ultrasonic.h"
 #include "Servo.h"
 #include "Alert.h"
-#include "Button.h"
+#include "Hal.h"
+#if ENABLE_TRACKING
+#include "Tracker.h"
+#endif
+
+// Scanner states (see STATE MACHINE above)
+enum ScanState : uint8_t {
+    SCAN_IDLE,
+    SCAN_MOVE,
+    SCAN_SETTLE,
+    SCAN_TRIGGER,
+    SCAN_WAIT_ECHO,
+    SCAN_EMIT
+};
+
+// Degrees per step through empty space (ENABLE_ADAPTIVE_SWEEP)
+#define ADAPTIVE_COARSE_STEP (SWEEP.coarseStep)
+
+// Sector first angle for an unused slot (ENABLE_PRIORITY_SECTORS)
+#define SECTOR_NONE 0xFF
+
+// Number of angles in one sweep (frame buffer size)
+#define SWEEP_ANGLES (SERVO_MAX_ANGLE - SERVO_MIN_ANGLE + 1)
+
+// Servo travel - the other sensors cover the rest of the range
+#define SCAN_MAX_ANGLE (SERVO_MAX_ANGLE - (SENSOR_COUNT - 1) * SENSOR_SPACING)
+
+static_assert(SENSOR_COUNT == 1 || SENSOR_SPACING <= SCAN_MAX_ANGLE - SERVO_MIN_ANGLE + 1,
+              "SENSOR_SPACING leaves angles no sensor reaches");
 
 class Scanner {
 public:
     // Constructor takes pointers to all required components
-    // This is dependency injection - makes testing easier
-    Scanner(Ultrasonic* ultra, ServoMotor* srv, Alert* alrt, Button* btn);
+    // This is dependency injection - makes testing easier.
+    // Interfaces, not drivers: see Hal.h
+    Scanner(RangeSensor* ultra, SweepServo* srv, ProximityAlert* alrt);
+
+    // Sensors 1...SENSOR_COUNT-1 (ultra is sensor 0).
+    // All of them must be set before start().
+    void setSensor(uint8_t index, RangeSensor* sensor);
     
-    // Perform one complete bidirectional sweep
-    // Returns false if interrupted by button press
-    bool scan(THReading* envData, float soundSpeed);
+    void start();               // Begin sweeping from the first angle of setSweep()
+    void stop();                // Abort sweep, silence alert
+    bool isScanning();
+    ScanState getState();
+    uint16_t getSweepCount();   // Sweeps begun since start()
+    void tick();                // Advance the state machine - call often
+
+    // Latest environment and Q16 ticks-to-mm factor (see SpeedOfSound.h)
+    void setEnvironment(THReading* envData, uint16_t distanceScale);
+
+    // Sweep the servo over minAngle..maxAngle in steps of stepDegrees
+    // (default: the whole profile, see SweepConfig.h). The range
+    // must lie within SERVO_MIN_ANGLE..SCAN_MAX_ANGLE, which size
+    // the frame buffers; the coarse step is never below the fine.
+    // Mid-sweep, the sweep goes on in its direction from inside the
+    // new range; it only ends at the end it was heading for.
+    void setSweep(int minAngle, int maxAngle, int stepDegrees);
+
+#if ENABLE_PRIORITY_SECTORS
+    // Priority sector index (0..PRIORITY_SECTORS-1) over servo angles
+    // first..last, within the sweep range; SECTOR_NONE clears it
+    void setSector(uint8_t index, uint8_t first, uint8_t last);
+    void setAutoSector(bool enabled);   // Extra sector at the nearest echo
+#endif
+
+    // Listen only up to gateMm (0 = full range, see RANGE_GATE)
+    void setRangeGate(uint16_t gateMm);
+
+    // Also send a RAW frame per ping (binary only, see RAW_CAPTURE)
+    void setRawCapture(bool enabled);
+
+    // Select CSV or binary output (OUTPUT_CSV / OUTPUT_BINARY)
+    void setOutputFormat(uint8_t format);
+    uint8_t getOutputFormat();
+
+    // Samples not sent because the serial TX buffer was full
+    uint16_t getSkippedSamples();
+
+    // Report a new environment reading
+    // Binary mode sends an ENVIRONMENT frame; CSV carries it per line
+    void printEnvironment(THReading* envData);
 
 private:
-    Ultrasonic* ultrasonic;
-    ServoMotor* servo;
-    Alert* alert;
-    Button* button;
+    RangeSensor* sensors[SENSOR_COUNT];
+    SweepServo* servo;
+    ProximityAlert* alert;
+    uint8_t outputFormat;
+
+    ScanState state;
+    int angle;                  // Current angle
+    int sweepMin;               // Servo travel, within the profile
+    int sweepMax;
+    int fineStep;               // Degrees per step (SERVO_STEP)
+    int coarseStep;             // Through empty space (ADAPTIVE_COARSE_STEP)
+    int passMin;                // Bounds of this pass: the sweep's, or a sector's
+    int passMax;
+    int step;                   // +fineStep forward, -fineStep backward
+    uint8_t sensor;             // Sensor being pinged at this angle
+    unsigned long deadline;     // micros() when the servo has settled
+    uint16_t distance;          // Last measurement (mm)
+    uint16_t ranges[SENSOR_COUNT];  // Latest measurement per sensor
+    uint8_t quality;            // Pings taken << 4 | pings agreeing
+    int16_t velocity;           // mm/s with the last measurement (ENABLE_TRACKING)
+    bool outputPending;         // distance/quality not sent yet (see PIPELINE)
+    int outputAngle;            // ...and the angle they belong to
+
+    uint16_t pings[PINGS_PER_ANGLE];    // This angle's readings, sorted
+    uint8_t pingCount;
+    unsigned long pingTime;     // millis() of the last trigger
+    unsigned long echoEnd[SENSOR_COUNT];    // millis() each sensor's last echo ended (PING_QUIET_TIME)
+    uint32_t triggerMicros;     // timer1Micros() of the last trigger (RAW, TIME)
+    bool rawCapture;
+
+    THReading environment;      // Cached copy for CSV lines
+    uint16_t distanceScale;
+    uint16_t rangeGate;         // mm, 0 = off
+
+    uint16_t sweepCount;        // Sweeps (one direction each) since start
+    bool keyframe;              // Current sweep sends every angle
+    uint16_t skippedSamples;    // Output skipped under backpressure
+#if ENABLE_DELTA_OUTPUT
+    uint16_t frame[SWEEP_ANGLES];   // Last distance sent per angle (mm)
+#endif
+
+#if ENABLE_ADAPTIVE_SWEEP
+    uint8_t hits[(SWEEP_ANGLES + 7) / 8];   // 1 bit per angle: echo in range
+    bool lastNear;              // Previous sample had an echo in range
+    uint8_t lastStride;         // Degrees moved by the previous step
+    bool isHit(int angle);
+    void setHit(int angle, bool hit);
+#endif
+
+    bool recordPing(uint16_t distanceMm);   // true when this angle is done
+    void resolvePings();        // Median and agreement into distance/quality
+
+#if ENABLE_TRACKING
+    Tracker tracker;
+    uint16_t arrivals[SENSOR_COUNT];    // ms, latest per sensor (ARRIVAL_NONE)
+    uint16_t nearestArrival();
+#endif
+
+#if ENABLE_PRIORITY_SECTORS
+    struct Sector {
+        uint8_t first;          // Servo angles, SECTOR_NONE = unused
+        uint8_t last;
+    };
+    Sector sectors[PRIORITY_SECTORS + 1];   // Set ones, then the automatic one
+    bool autoSector;
+    int8_t visiting;            // Sector being swept, -1 = the sweep
+    int travelled;              // Sweep degrees since the last turn
+    int resumeAngle;            // Where the sweep carries on
+    bool resumeForward;
+    uint16_t detectionMm;       // Nearest echo this sweep (automatic sector)
+    uint8_t detectionAngle;
+    unsigned long swingMargin;  // μs added to the next settle (PRIORITY_SWING_MARGIN)
+    bool scheduleSectors(int moved, bool reversed);     // true if the sweep ended
+    bool visitSector(uint8_t from);     // Next set sector from index on; false if none
+    void updateAutoSector();
+    void jumpTo(int target, bool forward);
+#endif
+
+#if ENABLE_SEGMENT_OUTPUT
+    struct Segment {
+        uint8_t first;          // Angle the segment was opened at
+        uint8_t last;           // Most recent angle added
+        uint16_t nearest;       // mm
+        uint16_t previous;      // mm, last sample added
+        uint8_t count;          // Samples, 0 = no segment open
+        uint32_t sum;           // mm, for the mean
+    };
+    Segment segments[SENSOR_COUNT];
+    void addSegmentSample(uint8_t n, int angle, uint16_t distanceMm);
+    void closeSegment(uint8_t n);
+    void closeSegments();
+#endif
+    bool segmentOutput();       // Segments replace samples
+
+#if ENABLE_PROFILE
+    unsigned long stepStart;    // micros() of the last MOVE
+    unsigned long stageStart;   // micros() when settle/echo began
+    uint32_t captureMicros;     // timer1Micros() when the last echo was seen
+#endif
+
+    int nextStride();           // Signed degrees to the next angle
+    bool advance(int stride);   // Move by stride, reversing at the ends; true if reversed
+    void beginSweep();          // Count sweep, decide keyframe, send marker
+    void beginMove();           // Command the servo to angle, enter SETTLE
+    void emitSample(int pointing);  // Send distance/quality, update alert
+    void flushOutput();         // Send the pending sample, if any
+    bool shouldSend(int angle, uint16_t distanceMm);
+    bool outputHasRoom();       // TX buffer can take one more record
+    uint16_t nearestRange();    // For the alert
+    void applyRangeGate();      // Pass gate and current scale to the sensors
 
-    // Output one measurement line to serial
-    void printData(int angle, float distance, THReading* envData);
+    // Output one measurement to serial
+    void printData(int angle, uint16_t distanceMm, uint8_t quality, THReading* envData);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+// Scheduler.cpp
+// Fixed-table cooperative scheduler
+
+#include <Arduino.h>
+#include "Scheduler.h"
+
+Scheduler::Scheduler() : count(0) {
+}
+
+bool Scheduler::addTask(TaskFunction function, unsigned long intervalMs) {
+    if (count >= MAX_TASKS) {
+        return false;
+    }
+    tasks[count].function = function;
+    tasks[count].interval = intervalMs;
+    tasks[count].next = millis();       // First run on the next pass
+    count++;
+    return true;
+}
+
+void Scheduler::run() {
+    for (uint8_t i = 0; i < count; i++) {
+        Task* task = &tasks[i];
+
+        if (task->interval == 0) {
+            task->function();
+            continue;
+        }
+
+        // DEADLINE CHECK:
+        // Signed difference handles millis() rollover (~49 days).
+        unsigned long now = millis();
+        if ((long)(now - task->next) < 0) {
+            continue;
+        }
+
+        task->next += task->interval;
+        if ((long)(now - task->next) >= 0) {
+            task->next = now + task->interval;  // Fell behind - resync
+        }
+        task->function();
+    }
+}
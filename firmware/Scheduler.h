@@ -0,0 +1,49 @@
+// Scheduler.h
+// Cooperative Task Scheduler
+//
+// PURPOSE:
+// Runs several small jobs (scanner, button, DHT, ...) from one main
+// loop without any of them calling delay(). Each task is a plain
+// function that does a little work and returns quickly; the
+// scheduler calls it again when its interval has elapsed.
+//
+// COOPERATIVE, NOT PREEMPTIVE:
+// A task is never interrupted by another task. If a task blocks,
+// everything waits - so tasks must keep state and return instead
+// of waiting (see Scanner::tick() for the pattern).
+//
+// TIMING:
+// Deadlines are kept in millis(). Interval 0 means "every pass".
+// A periodic task keeps a steady cadence (next += interval) unless
+// it falls more than one interval behind, then it resyncs to now.
+//
+// Tasks are stored in a fixed array - no dynamic allocation.
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "config.h"
+
+// Maximum number of tasks (each costs 10 bytes of SRAM)
+#define MAX_TASKS 6
+
+typedef void (*TaskFunction)();
+
+class Scheduler {
+public:
+    Scheduler();
+    bool addTask(TaskFunction function, unsigned long intervalMs);  // false if table full
+    void run();                 // One pass: run every task that is due
+
+private:
+    struct Task {
+        TaskFunction function;
+        unsigned long interval;     // ms between runs, 0 = every pass
+        unsigned long next;         // millis() deadline of next run
+    };
+
+    Task tasks[MAX_TASKS];
+    uint8_t count;
+};
+
+#endif
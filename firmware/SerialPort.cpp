@@ -0,0 +1,219 @@
+// SerialPort.cpp
+// USART0 driver with interrupt-drained TX ring buffer
+
+#include <Arduino.h>
+#include <util/atomic.h>
+#include "SerialPort.h"
+#include "Timer1.h"
+
+#define TX_MASK (SERIAL_TX_BUFFER_SIZE - 1)
+#define RX_MASK (SERIAL_RX_BUFFER_SIZE - 1)
+
+static_assert((SERIAL_TX_BUFFER_SIZE & TX_MASK) == 0 && SERIAL_TX_BUFFER_SIZE <= 256,
+              "SERIAL_TX_BUFFER_SIZE must be a power of two up to 256");
+static_assert((SERIAL_RX_BUFFER_SIZE & RX_MASK) == 0 && SERIAL_RX_BUFFER_SIZE <= 256,
+              "SERIAL_RX_BUFFER_SIZE must be a power of two up to 256");
+
+SerialPort serialPort;
+
+// USART ISRs:
+// UDRE fires whenever the transmit register is empty, so it stays
+// enabled only while the ring buffer has data.
+ISR(USART_UDRE_vect) {
+    serialPort.txInterrupt();
+}
+
+ISR(USART_RX_vect) {
+    serialPort.rxInterrupt();
+}
+
+void SerialPort::begin(unsigned long baud) {
+    txHead = txTail = 0;
+    rxHead = rxTail = 0;
+    dropped = stalled = rxDropped = 0;
+    written = false;
+#if ENABLE_PROFILE
+    probeBytes = 0;
+    probing = false;
+#endif
+
+    // BAUD RATE (double speed mode, same formula as HardwareSerial):
+    //   UBRR = F_CPU / (8 × baud) - 1, rounded
+    // 115200 baud at 16MHz → UBRR 16 (2.1% error, within tolerance)
+    UCSR0A = (1 << U2X0);
+    UBRR0 = (F_CPU / 4 / baud - 1) / 2;
+
+    UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);     // 8 data bits, no parity, 1 stop
+    UCSR0B = (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
+}
+
+// Free slots; one slot stays empty to tell full from empty
+uint8_t SerialPort::txFree() {
+    return (uint8_t)(txTail - txHead - 1) & TX_MASK;
+}
+
+uint16_t SerialPort::availableForWrite() {
+    uint8_t free;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        free = txFree();
+    }
+    return free;
+}
+
+void SerialPort::txInterrupt() {
+    if (txHead == txTail) {
+        UCSR0B &= ~(1 << UDRIE0);       // Nothing left - stop interrupting
+        return;
+    }
+    UDR0 = txBuffer[txTail];
+    txTail = (txTail + 1) & TX_MASK;
+    UCSR0A = (UCSR0A & ((1 << U2X0) | (1 << MPCM0))) | (1 << TXC0);    // Clear TXC0 for flush()
+#if ENABLE_PROFILE
+    if (probeBytes != 0 && --probeBytes == 0) {
+        probeEnd = timer1Micros();
+    }
+#endif
+}
+
+void SerialPort::rxInterrupt() {
+    uint8_t byte = UDR0;
+    uint8_t next = (rxHead + 1) & RX_MASK;
+    if (next == rxTail) {
+        rxDropped++;
+        return;
+    }
+    rxBuffer[rxHead] = byte;
+    rxHead = next;
+}
+
+size_t SerialPort::write(uint8_t byte) {
+    written = true;
+
+    // FAST PATH:
+    // Buffer empty and UART idle → straight into the data register.
+    if (txHead == txTail && (UCSR0A & (1 << UDRE0))) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            UDR0 = byte;
+            UCSR0A = (UCSR0A & ((1 << U2X0) | (1 << MPCM0))) | (1 << TXC0);
+        }
+        return 1;
+    }
+
+    // FULL BUFFER:
+    // Wait for the ISR to make room. With interrupts disabled (called
+    // from an ISR) the ISR can't run, so drain by hand.
+    if (txFree() == 0) {
+        stalled++;
+        while (txFree() == 0) {
+            if (bit_is_clear(SREG, SREG_I) && (UCSR0A & (1 << UDRE0))) {
+                txInterrupt();
+            }
+        }
+    }
+
+    txBuffer[txHead] = byte;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        txHead = (txHead + 1) & TX_MASK;
+        UCSR0B |= (1 << UDRIE0);
+    }
+    return 1;
+}
+
+size_t SerialPort::write(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        write(data[i]);
+    }
+    return length;
+}
+
+// NON-BLOCKING WRITE:
+// Either the whole block fits and is queued, or nothing is written.
+// A partial frame would only cost the receiver a resync.
+bool SerialPort::tryWrite(const uint8_t* data, uint8_t length) {
+    if (availableForWrite() < length) {
+        dropped += length;
+        return false;
+    }
+
+    written = true;
+    for (uint8_t i = 0; i < length; i++) {
+        txBuffer[txHead] = data[i];
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            txHead = (txHead + 1) & TX_MASK;
+        }
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        UCSR0B |= (1 << UDRIE0);
+    }
+    return true;
+}
+
+void SerialPort::flush() {
+    // Wait until the buffer is empty and the last byte has left
+    // the shift register
+    if (!written) {
+        return;
+    }
+    while (txHead != txTail) {
+    }
+    while (!(UCSR0A & (1 << TXC0))) {
+    }
+}
+
+int SerialPort::available() {
+    return (uint8_t)(rxHead - rxTail) & RX_MASK;
+}
+
+int SerialPort::read() {
+    if (rxHead == rxTail) {
+        return -1;
+    }
+    uint8_t byte = rxBuffer[rxTail];
+    rxTail = (rxTail + 1) & RX_MASK;
+    return byte;
+}
+
+uint32_t SerialPort::droppedBytes() {
+    return dropped;
+}
+
+uint32_t SerialPort::stalledBytes() {
+    return stalled;
+}
+
+uint32_t SerialPort::rxDroppedBytes() {
+    uint32_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        count = rxDropped;
+    }
+    return count;
+}
+
+#if ENABLE_PROFILE
+// Bytes that took the fast path are already in the UART, so an
+// empty ring means done right away
+void SerialPort::txProbeStart() {
+    if (probing) {
+        return;
+    }
+    probing = true;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        probeStart = timer1Micros();
+        probeEnd = probeStart;
+        probeBytes = (uint8_t)(txHead - txTail) & TX_MASK;
+    }
+}
+
+bool SerialPort::txProbeDone(uint32_t* micros) {
+    uint32_t end;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!probing || probeBytes != 0) {
+            return false;
+        }
+        end = probeEnd;
+    }
+    probing = false;
+    *micros = end - probeStart;
+    return true;
+}
+#endif
@@ -0,0 +1,101 @@
+// SerialPort.h
+// Interrupt-Driven Serial Port (USART0)
+//
+// PURPOSE:
+// Replaces the Arduino HardwareSerial object. Its 64-byte TX buffer
+// fills with two or three CSV lines, after which every print()
+// blocks the scan loop until the UART catches up.
+//
+// TX RING BUFFER:
+// Bytes are queued in a ring buffer (SERIAL_TX_BUFFER_SIZE in
+// config.h) and sent by the UDRE (Data Register Empty) interrupt,
+// one byte each time the UART is ready for the next:
+//
+//   write() → [ring buffer] → UDRE ISR → UDR0 → TX pin
+//
+// Two ways to write:
+//   write()/print()  Blocks while the buffer is full (text messages
+//                    that must not be lost). Counted as stalls.
+//   tryWrite()       All-or-nothing, never blocks. Returns false if
+//                    the data doesn't fit (backpressure); the caller
+//                    decides to skip or retry. Counted as drops.
+//
+// TX PROBE (ENABLE_PROFILE):
+// txProbeStart() notes the time and how many bytes are queued; the
+// UDRE ISR counts them down and stamps the moment the last one goes
+// into UDR0. txProbeDone() then hands back how long that took - the
+// queueing delay of whatever was written last, up to the UART rather
+// than onto the wire: the byte's own shift-out is not included
+// (TXC0 only marks the end of the last byte queued, and flush()
+// polls it). One probe at a time.
+//
+// RX:
+// Received bytes are queued by the RX interrupt for available()/
+// read(), like Serial. Bytes arriving to a full buffer are dropped.
+//
+// The Arduino core's Serial object and its ISRs are only linked in
+// when something references Serial, so nothing in the firmware may
+// use it alongside this class.
+
+#ifndef SERIALPORT_H
+#define SERIALPORT_H
+
+#include <Arduino.h>
+#include "config.h"
+
+class SerialPort : public Print {
+public:
+    void begin(unsigned long baud);
+
+    // Print interface (print(), println() build on these)
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t* data, size_t length) override;
+    using Print::write;
+
+    bool tryWrite(const uint8_t* data, uint8_t length);    // Never blocks
+    uint16_t availableForWrite();   // Free space in the TX buffer
+    void flush();                   // Wait until everything is sent
+
+    int available();                // Bytes waiting in the RX buffer
+    int read();                     // Next byte, or -1 if none
+
+    // COUNTERS (since boot):
+    uint32_t droppedBytes();        // Refused by tryWrite()
+    uint32_t stalledBytes();        // Had to wait for space in write()
+    uint32_t rxDroppedBytes();      // Lost because the RX buffer was full
+
+#if ENABLE_PROFILE
+    void txProbeStart();            // No-op while a probe is running
+    bool txProbeDone(uint32_t* micros);     // Once per probe: μs until loaded into UDR0
+#endif
+
+    // Called from the USART ISRs only
+    void txInterrupt();
+    void rxInterrupt();
+
+private:
+    volatile uint8_t txBuffer[SERIAL_TX_BUFFER_SIZE];
+    volatile uint8_t txHead;        // Next slot to fill
+    volatile uint8_t txTail;        // Next byte to send
+    volatile uint8_t rxBuffer[SERIAL_RX_BUFFER_SIZE];
+    volatile uint8_t rxHead;
+    volatile uint8_t rxTail;
+
+    uint32_t dropped;
+    uint32_t stalled;
+    volatile uint32_t rxDropped;
+    bool written;                   // Anything sent yet? (flush() needs TXC0)
+#if ENABLE_PROFILE
+    volatile uint8_t probeBytes;    // Still to send, 0 = probe finished
+    bool probing;
+    uint32_t probeStart;            // timer1Micros()
+    volatile uint32_t probeEnd;
+#endif
+
+    uint8_t txFree();
+};
+
+// One UART, one instance - used everywhere instead of Serial
+extern SerialPort serialPort;
+
+#endif
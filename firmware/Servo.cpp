@@ -1,36 +1,169 @@
 // Servo.cpp
-// SG90 servo wrapper with attach/detach for ultrasonic compatibility
+// SG90 servo driver on Timer1 Output Compare A (OC1A)
 
 #include <Arduino.h>
+#include <util/atomic.h>
 #include "Servo.h"
+#include "Timer1.h"
+#include "SerialPort.h"
+
+// PULSE TABLE:
+// Linear map 0-180° → SERVO_MIN_PULSE-SERVO_MAX_PULSE μs, in Timer1
+// ticks. Worked out per call this was a 32-bit multiply and divide
+// (~40μs on the AVR) on every move; the templates below evaluate
+// it at compile time instead, one entry per angle of the selected
+// sweep profile (322 bytes of flash for SWEEP_WIDE_FINE).
+constexpr uint16_t pulseTicksFor(int angle) {
+    return (SERVO_MIN_PULSE +
+            (uint32_t)(SERVO_MAX_PULSE - SERVO_MIN_PULSE) * angle / 180) * TIMER1_TICKS_PER_US;
+}
+
+static_assert(pulseTicksFor(0) == SERVO_MIN_PULSE * TIMER1_TICKS_PER_US, "Pulse table start point");
+static_assert(pulseTicksFor(180) == SERVO_MAX_PULSE * TIMER1_TICKS_PER_US, "Pulse table end point");
+
+#define PULSE_ANGLES (SERVO_MAX_ANGLE - SERVO_MIN_ANGLE + 1)
+
+struct PulseTable {
+    uint16_t ticks[PULSE_ANGLES];
+};
+
+// Indices<0, 1, ... N-1>, built by prepending N-1 until N reaches 0
+template <int... I> struct Indices {};
+template <int N, int... I> struct IndicesFor : IndicesFor<N - 1, N - 1, I...> {};
+template <int... I> struct IndicesFor<0, I...> { typedef Indices<I...> type; };
+
+template <int... I>
+constexpr PulseTable pulseTableFor(Indices<I...>) {
+    return PulseTable{ { pulseTicksFor(SERVO_MIN_ANGLE + I)... } };
+}
+
+// A plain (non-template) object so PROGMEM places it in flash
+static const PulseTable pulseTable PROGMEM = pulseTableFor(IndicesFor<PULSE_ANGLES>::type());
+
+// Pulse width in Timer1 ticks, written by setAngle(), read by the ISR
+static volatile uint16_t pulseTicks = SERVO_MIN_PULSE * TIMER1_TICKS_PER_US;
+
+// Pin level set by the compare match that just fired
+static volatile bool pinHigh = false;
+
+// Set by detach(); the ISR stops after the current pulse ends so
+// the servo never sees a truncated pulse
+static volatile bool detachPending = false;
+
+// OC1A output modes (TCCR1A COM1A bits)
+#define OC1A_SET   ((1 << COM1A1) | (1 << COM1A0))  // Set pin on match
+#define OC1A_CLEAR (1 << COM1A1)                    // Clear pin on match
+#define OC1A_MASK  ((1 << COM1A1) | (1 << COM1A0))
+
+// COMPARE MATCH ISR:
+// The hardware has already changed the pin. We queue the opposite
+// edge: end of pulse after pulseTicks, next pulse after the rest
+// of the 20ms period. OCR1A wraps with TCNT1, so += is all we need.
+ISR(TIMER1_COMPA_vect) {
+    uint8_t mode = TCCR1A & ~OC1A_MASK;
+
+    if (!pinHigh) {
+        // Pulse just started
+        OCR1A += pulseTicks;
+        TCCR1A = mode | OC1A_CLEAR;
+        pinHigh = true;
+        return;
+    }
+
+    // Pulse just ended
+    pinHigh = false;
+    if (detachPending) {
+        TIMSK1 &= ~(1 << OCIE1A);
+        TCCR1A = mode;                  // Disconnect OC1A → PORTB (LOW)
+        detachPending = false;
+        return;
+    }
+    OCR1A += (uint16_t)(SERVO_PERIOD * TIMER1_TICKS_PER_US) - pulseTicks;
+    TCCR1A = mode | OC1A_SET;
+}
 
 void ServoMotor::init() {
-    servo.attach(SERVO_PIN);
-    servo.write(90);    // Start at center position
+    timer1Init();
+    SERVO_PORT &= ~(1 << SERVO_BIT);    // Idle level LOW when disconnected
+    SERVO_DDR |= (1 << SERVO_BIT);      // OC1A as OUTPUT
+    settleBase = SERVO_SETTLE_BASE;
+    setAngle((SERVO_MIN_ANGLE + SERVO_MAX_ANGLE) / 2);  // Start at center of the sweep
+    attach();
     delay(60);          // Allow servo to reach position
-    Serial.println(F("SG90 initialized"));
+    serialPort.println(F("SG90 initialized (Timer1 OC1A)"));
 }
 
 void ServoMotor::setAngle(int angle) {
-    servo.write(angle);
+    angle = constrain(angle, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+    position = angle;
+
+    uint16_t ticks = pgm_read_word(&pulseTable.ticks[angle - SERVO_MIN_ANGLE]);
+
+    // 16-bit write must not be torn by the ISR reading it
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        pulseTicks = ticks;
+    }
 }
 
-// DETACH/ATTACH PATTERN:
-// The Arduino Servo library uses Timer1 interrupts to generate
-// PWM signals. Our ultrasonic measurement also uses Timer1 for
-// Input Capture timing.
-//
-// When both run simultaneously, the servo's PWM configuration
-// conflicts with our Input Capture setup, leading to distance
-// errors of several centimeters.
-//
-// By detaching the servo during ultrasonic measurement, we
-// free Timer1 for accurate pulse timing.
+// Time until the next pulse starts, i.e. until the servo sees a
+// pulse width written now. A pulse already in progress was
+// latched with the old width, so then it is the one after.
+unsigned long ServoMotor::microsToNextPulse() {
+    uint16_t remaining;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!(TIMSK1 & (1 << OCIE1A))) {
+            return 0;                   // Detached - nothing to wait for
+        }
+        remaining = OCR1A - TCNT1;      // Ticks until the next edge
+        if (pinHigh) {
+            remaining += (uint16_t)(SERVO_PERIOD * TIMER1_TICKS_PER_US) - pulseTicks;
+        }
+    }
+    return remaining / TIMER1_TICKS_PER_US;
+}
+
+unsigned long ServoMotor::moveTo(int angle) {
+    int from = position;
+    setAngle(angle);
+    unsigned int degrees = abs(position - from);
+
+    return micros() + microsToNextPulse() + settleBase +
+           (unsigned long)degrees * SERVO_SETTLE_PER_DEGREE;
+}
+
+void ServoMotor::setSettleBase(uint16_t us) {
+    settleBase = us;
+}
+
+// DETACH/ATTACH:
+// No longer needed around measurements. Kept for parking the servo
+// (no holding current, no buzzing) while the system is idle.
 
 void ServoMotor::detach() {
-    servo.detach();
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (TIMSK1 & (1 << OCIE1A)) {
+            detachPending = true;
+        }
+    }
+}
+
+// detach() waits for the current pulse to end
+bool ServoMotor::isAttached() {
+    return (TIMSK1 & (1 << OCIE1A)) != 0;
 }
 
 void ServoMotor::attach() {
-    servo.attach(SERVO_PIN);
-}
\ No newline at end of file
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        detachPending = false;
+        if (TIMSK1 & (1 << OCIE1A)) {
+            return;                     // Already running
+        }
+
+        // First edge shortly from now, then the ISR keeps it going
+        pinHigh = false;
+        TCCR1A = (TCCR1A & ~OC1A_MASK) | OC1A_SET;
+        OCR1A = TCNT1 + 100;
+        TIFR1 = (1 << OCF1A);           // Clear stale match flag
+        TIMSK1 |= (1 << OCIE1A);
+    }
+}
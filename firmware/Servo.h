@@ -5,15 +5,22 @@
 // Rotates the ultrasonic sensor to scan 180 degrees,
 // creating a radar-like sweep pattern.
 //
-// PWM INTERFERENCE ISSUE:
-// Both the Servo library and pulseIn() use timer interrupts.
-// When the servo is attached, its PWM signal can interfere
-// with precise timing measurements from the ultrasonic sensor.
+// TIMER1 SHARING:
+// The Arduino Servo library reprograms Timer1 for its own use,
+// which clashes with the ultrasonic Input Capture. The old fix
+// was to detach() before every reading and attach() afterwards,
+// costing ~5ms and a twitch at every step.
 //
 // SOLUTION:
-// We detach() the servo before taking ultrasonic readings,
-// then attach() it again afterward. This ensures clean
-// pulse timing for distance measurement.
+// We generate the pulse ourselves on OC1A (D9), the Output Compare
+// pin of the same free-running Timer1 that Input Capture uses
+// (see Timer1.h). The hardware sets/clears the pin on compare
+// match, so edges are jitter-free; the ISR only schedules the
+// next edge. The servo stays attached and holds position while
+// the sensor measures.
+//
+//   OC1A:  ‾‾‾|_______________________|‾‾‾|_____...
+//          pulse      20ms - pulse     pulse
 //
 // SG90 SPECS:
 //   - Operating voltage: 4.8-6V
@@ -25,32 +32,57 @@
 #ifndef SERVO_H
 #define SERVO_H
 
-#include <Servo.h>
 #include "config.h"
+#include "Hal.h"
+#include "SweepConfig.h"
 
-// Servo movement limits
-#define SERVO_MIN_ANGLE 10
-#define SERVO_MAX_ANGLE 170
+// Servo movement limits (from SWEEP_PROFILE, see SweepConfig.h)
+#define SERVO_MIN_ANGLE (SWEEP.minAngle)
+#define SERVO_MAX_ANGLE (SWEEP.maxAngle)
 
 // Sweep configuration
 // Note: HC-SR04 has 15° beam width, so 1° step creates overlap
 // This is intentional for smooth radar display visualization
-#define SERVO_STEP 1
+#define SERVO_STEP (SWEEP.step)
 
-// Delay between steps (ms)
-// Must allow servo to reach position before measurement
-// SG90 needs ~1.7ms per degree, but we use 60ms for stability
-// and to meet HC-SR04's recommended 60ms measurement cycle
-#define SERVO_DELAY 25
+// SETTLE MODEL:
+// A fixed delay after every move wastes time on 1° steps and may be
+// too short for a full reversal. Instead moveTo() predicts when the
+// servo will have arrived:
+//
+//   settle = wait for next pulse + SERVO_SETTLE_BASE
+//            + degrees moved × SERVO_SETTLE_PER_DEGREE
+//
+//   - Next pulse: the servo only sees the new angle when its next
+//     pulse starts (up to 20ms). The driver knows exactly when.
+//   - Base: control loop reaction plus damping of the overshoot
+//     (default - setSettleBase() trims it for a slower or
+//     heavier-loaded servo without a reflash)
+//   - Per degree: SG90 does ~0.1s per 60° → ~1.7ms per degree
+#define SERVO_SETTLE_BASE       4000    // μs
+#define SERVO_SETTLE_PER_DEGREE 1700    // μs
 
-class ServoMotor {
+// Pulse timing (μs)
+// Same endpoints as the Arduino Servo library, so angles map
+// to the same positions as before
+#define SERVO_MIN_PULSE 544     // 0°
+#define SERVO_MAX_PULSE 2400    // 180°
+#define SERVO_PERIOD 20000      // 50Hz
+
+class ServoMotor : public SweepServo {
 public:
     void init();
     void setAngle(int angle);
-    void detach();      // Detach before ultrasonic reading
-    void attach();      // Re-attach after reading
+    unsigned long moveTo(int angle) override;   // setAngle(), returns micros() settle deadline
+    void detach();      // Stop pulses (servo goes limp)
+    void attach();      // Resume pulses at the last angle
+    bool isAttached();  // False once a detach() has taken effect
+    void setSettleBase(uint16_t us);    // Replaces SERVO_SETTLE_BASE
+
 private:
-    Servo servo;
+    int position;       // Last commanded angle
+    uint16_t settleBase;    // μs, see SETTLE MODEL
+    unsigned long microsToNextPulse();
 };
 
-#endif
\ No newline at end of file
+#endif
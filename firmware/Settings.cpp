@@ -0,0 +1,105 @@
+// Settings.cpp
+// Run-time parameters, validated and kept in EEPROM
+
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include "Settings.h"
+#include "Alert.h"
+#include "Protocol.h"
+#include "Scanner.h"
+#include "Servo.h"
+#include "Ultrasonic.h"
+
+#define SETTINGS_MAGIC 0x5E
+#define SETTINGS_IMAGE_SIZE (2 + sizeof(Settings) + 1)  // magic, size, record, crc
+
+// Farthest distance worth setting a zone or gate to (mm)
+#define SETTINGS_MAX_MM (MAX_DISTANCE * 10)
+
+// Image staged by settingsSave(); bytes before `saved` are written
+static uint8_t image[SETTINGS_IMAGE_SIZE];
+static uint8_t saved = SETTINGS_IMAGE_SIZE;
+
+void settingsDefaults(Settings* settings) {
+    settings->sweepMin = SERVO_MIN_ANGLE;
+    settings->sweepMax = SCAN_MAX_ANGLE;
+    settings->step = SERVO_STEP;
+    settings->settleUs = SERVO_SETTLE_BASE;
+    settings->warnMm = ALERT_THRESHOLD;
+    settings->dangerMm = DANGER_THRESHOLD;
+    settings->gateMm = RANGE_GATE;
+    settings->format = OUTPUT_FORMAT;
+#if ENABLE_PRIORITY_SECTORS
+    for (uint8_t i = 0; i < PRIORITY_SECTORS; i++) {
+        settings->sectorFirst[i] = SECTOR_NONE;
+        settings->sectorLast[i] = SECTOR_NONE;
+    }
+    settings->sectorAuto = 0;
+#endif
+}
+
+bool settingsValid(const Settings* settings) {
+    if (settings->sweepMin < SERVO_MIN_ANGLE || settings->sweepMax > SCAN_MAX_ANGLE ||
+        settings->sweepMin >= settings->sweepMax) {
+        return false;
+    }
+    if (settings->step < 1 || settings->step > settings->sweepMax - settings->sweepMin) {
+        return false;
+    }
+    if (settings->warnMm > SETTINGS_MAX_MM || settings->dangerMm >= settings->warnMm) {
+        return false;
+    }
+    if (settings->gateMm > SETTINGS_MAX_MM) {
+        return false;
+    }
+#if ENABLE_PRIORITY_SECTORS
+    for (uint8_t i = 0; i < PRIORITY_SECTORS; i++) {
+        if (settings->sectorFirst[i] != SECTOR_NONE &&
+            (settings->sectorFirst[i] < settings->sweepMin || settings->sectorLast[i] > settings->sweepMax ||
+             settings->sectorFirst[i] > settings->sectorLast[i])) {
+            return false;
+        }
+    }
+    if (settings->sectorAuto > 1) {
+        return false;
+    }
+#endif
+    return settings->format == OUTPUT_CSV || settings->format == OUTPUT_BINARY;
+}
+
+bool settingsLoad(Settings* settings) {
+    uint8_t stored[SETTINGS_IMAGE_SIZE];
+    eeprom_read_block(stored, (const void*)0, sizeof(stored));
+
+    if (stored[0] == SETTINGS_MAGIC && stored[1] == sizeof(Settings) &&
+        stored[SETTINGS_IMAGE_SIZE - 1] == crc8(stored, SETTINGS_IMAGE_SIZE - 1)) {
+        memcpy(settings, &stored[2], sizeof(Settings));
+        if (settingsValid(settings)) {
+            return true;
+        }
+    }
+    settingsDefaults(settings);
+    return false;
+}
+
+// A save while one is still under way starts over with the newer
+// record; the CRC is only written once the whole record is in.
+void settingsSave(const Settings* settings) {
+    image[0] = SETTINGS_MAGIC;
+    image[1] = sizeof(Settings);
+    memcpy(&image[2], settings, sizeof(Settings));
+    image[SETTINGS_IMAGE_SIZE - 1] = crc8(image, SETTINGS_IMAGE_SIZE - 1);
+    saved = 0;
+}
+
+bool settingsSaving() {
+    return saved < SETTINGS_IMAGE_SIZE;
+}
+
+void settingsService() {
+    if (!settingsSaving() || !eeprom_is_ready()) {
+        return;
+    }
+    eeprom_update_byte((uint8_t*)(uintptr_t)saved, image[saved]);
+    saved++;
+}
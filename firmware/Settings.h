@@ -0,0 +1,66 @@
+// Settings.h
+// Run-Time Parameters and EEPROM Persistence
+//
+// PURPOSE:
+// Sweep range and step, servo settle time, alert zones, range
+// gate and output format used to be compile-time constants, so
+// trading resolution for refresh rate at a site meant a reflash.
+// They now live in one Settings record that serial commands edit
+// live (see SERIAL COMMANDS in firmware.ino) and SAVE keeps.
+// The constants in config.h and the drivers are the defaults.
+//
+// LIMITS:
+// The sweep range can be narrowed, not widened: the frame buffer,
+// hit map and tracks are sized for the compiled profile (see
+// SweepConfig.h), so the range must lie within SERVO_MIN_ANGLE
+// and SCAN_MAX_ANGLE. Priority sectors must lie within the range,
+// so clear them before narrowing it past them. settingsValid()
+// checks every field; records that fail it are never applied.
+//
+// EEPROM IMAGE (address 0):
+//   [0x5E][size][Settings...][crc8]
+// size is sizeof(Settings), so a firmware with a different layout
+// ignores the image instead of misreading it; crc8 (Protocol.h)
+// covers everything before it. A blank, torn or foreign image -
+// or one whose range the current profile can't sweep - loads as
+// the defaults.
+//
+// NON-BLOCKING SAVE:
+// Each EEPROM byte takes 3.4ms to write, 50ms for the record -
+// longer than a sweep step. settingsSave() only stages the image;
+// settingsService() writes one byte per call, and only when the
+// EEPROM is idle, so the scan never waits on it. Bytes already
+// holding the right value are skipped (eeprom_update_byte), which
+// also spares the 100,000-cycle endurance. The CRC is written
+// last: power lost mid-save leaves an image that fails its check.
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include "config.h"
+
+struct Settings {
+    uint8_t sweepMin;       // degrees, servo travel
+    uint8_t sweepMax;
+    uint8_t step;           // degrees per fine step
+    uint16_t settleUs;      // Servo settle base (SERVO_SETTLE_BASE)
+    uint16_t warnMm;        // Alert zones (ALERT_THRESHOLD, DANGER_THRESHOLD)
+    uint16_t dangerMm;
+    uint16_t gateMm;        // RANGE_GATE, 0 = full range
+    uint8_t format;         // OUTPUT_CSV / OUTPUT_BINARY
+#if ENABLE_PRIORITY_SECTORS
+    uint8_t sectorFirst[PRIORITY_SECTORS];  // Servo angles, SECTOR_NONE = unused
+    uint8_t sectorLast[PRIORITY_SECTORS];
+    uint8_t sectorAuto;     // 1 = automatic sector at the nearest echo
+#endif
+};
+
+void settingsDefaults(Settings* settings);      // Compiled-in values
+bool settingsValid(const Settings* settings);   // Within the limits above
+bool settingsLoad(Settings* settings);          // false: defaults loaded instead
+
+void settingsSave(const Settings* settings);    // Stage for writing, returns at once
+bool settingsSaving();                          // Bytes still to write
+void settingsService();                         // Write the next byte - call often
+
+#endif
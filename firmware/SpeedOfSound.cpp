@@ -31,4 +31,37 @@
 
 float calculateSpeedOfSound(float tempC, float humidity) {
     return 331.3 + (0.606 * tempC) + (0.0124 * humidity);
-}
\ No newline at end of file
+}
+
+// Q16 SCALE DERIVATION:
+//   mm per tick = 0.5μs × speed(m/s) × 0.001(mm/μs per m/s) / 2
+//               = speed × 0.00025
+//   Q16 scale   = speed × 0.00025 × 65536 = speed × 16.384
+//
+// PRECISION:
+// Scale rounding is at most 0.5 / 5400 ≈ 0.01%, i.e. 0.4mm at 400cm,
+// well inside the HC-SR04's 3mm accuracy.
+//
+// OVERFLOW:
+// 65535 ticks × 5942 (362 m/s at 50°C, 90% RH) ≈ 3.9e8 < 2^32,
+// so the per-sample product always fits in 32 bits.
+uint16_t calculateDistanceScale(float soundSpeed) {
+    return (uint16_t)(soundSpeed * 16.384f + 0.5f);
+}
+
+// INTEGER COEFFICIENTS:
+// The formula above is linear, so the scale is too - no table
+// needed. Multiplied out by 16.384 and kept in Q8:
+//   base   331.3  × 16.384 × 256 = 1389560
+//   T10    0.0606 × 16.384 × 256 =     254   (per 0.1°C)
+//   RH     0.0124 × 16.384 × 256 =      52   (per %)
+// Rounded coefficients are off by < 0.4 over 0-50°C, 0-100% RH.
+#define SCALE_BASE_Q8 1389560L
+#define SCALE_T10_Q8  254
+#define SCALE_RH_Q8   52
+
+uint16_t distanceScaleFor(int16_t tempC10, uint8_t humidity) {
+    int32_t q8 = SCALE_BASE_Q8 + (int32_t)tempC10 * SCALE_T10_Q8
+                 + (int32_t)humidity * SCALE_RH_Q8;
+    return (uint16_t)((q8 + 128) >> 8);
+}
@@ -30,4 +30,32 @@
 //   Speed of sound in m/s
 float calculateSpeedOfSound(float tempC, float humidity);
 
+// FIXED-POINT DISTANCE SCALE:
+// The ATmega328P has no FPU, so float math per sample is slow.
+// Instead we fold the whole conversion chain into one Q16 factor,
+// computed once per environment update:
+//   distance(mm) = (ticks × scale) >> 16
+// where ticks are Timer1 ticks (0.5μs) of the echo pulse.
+//
+// Parameters:
+//   soundSpeed - Speed of sound in m/s
+// Returns:
+//   Q16 ticks-to-mm factor (~5620 at 343 m/s)
+uint16_t calculateDistanceScale(float soundSpeed);
+
+// INTEGER PATH:
+// Same result as calculateDistanceScale(calculateSpeedOfSound())
+// (within 1), straight from the DHT11's integer fields - no float
+// math at all when the environment changes.
+//
+// Parameters:
+//   tempC10  - Temperature in tenths of °C (THReading::temperatureC10)
+//   humidity - Relative humidity in % (THReading::humidityRH)
+// Returns:
+//   Q16 ticks-to-mm factor
+uint16_t distanceScaleFor(int16_t tempC10, uint8_t humidity);
+
+// Scale at the standard 343 m/s (20°C, 50% RH) fallback
+#define DEFAULT_DISTANCE_SCALE 5620
+
 #endif
\ No newline at end of file
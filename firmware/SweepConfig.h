@@ -0,0 +1,50 @@
+// SweepConfig.h
+// Compile-Time Sweep Geometry
+//
+// PURPOSE:
+// Everything that shapes a sweep - where it starts and ends, the
+// fine step and the adaptive coarse step - lives in one constexpr
+// SweepConfig. config.h picks a profile with SWEEP_PROFILE; the
+// servo limits, the per-angle buffers (frame, hits, tracks), the
+// servo pulse table and the look-ahead all derive from it at
+// compile time, so a narrow build also gets smaller buffers and
+// tables, not just a different loop bound.
+//
+// Only the pulse widths are precomputed. Settle times stay a
+// runtime sum (see SETTLE MODEL in Servo.h): they depend on how
+// far each move goes, and the base is trimmed over serial. The
+// angle sequence is runtime too, since the adaptive sweep picks
+// each step from the last echo.
+//
+// PROFILES:
+//   SWEEP_WIDE_FINE   10°-170°, 1° steps (5° through empty space)
+//                     Full coverage, ~5s per sweep
+//   SWEEP_NARROW_FAST 50°-130°, 2° steps (6° through empty space)
+//                     Forward sector only, ~1.2s per sweep
+//
+// A new profile is one more line below; the static_asserts check
+// it against the servo's range.
+
+#ifndef SWEEP_CONFIG_H
+#define SWEEP_CONFIG_H
+
+#include "config.h"
+
+struct SweepConfig {
+    int minAngle;           // degrees, first angle of a forward sweep
+    int maxAngle;           // degrees, last angle
+    int step;               // degrees per fine step
+    int coarseStep;         // degrees per step through empty space (ENABLE_ADAPTIVE_SWEEP)
+};
+
+constexpr SweepConfig SWEEP_WIDE_FINE   = { 10, 170, 1, 5 };
+constexpr SweepConfig SWEEP_NARROW_FAST = { 50, 130, 2, 6 };
+
+// The profile this build uses (SWEEP_PROFILE in config.h)
+constexpr SweepConfig SWEEP = SWEEP_PROFILE;
+
+static_assert(SWEEP.minAngle >= 0 && SWEEP.maxAngle <= 180, "Sweep outside the servo's 0-180°");
+static_assert(SWEEP.minAngle < SWEEP.maxAngle, "Sweep must span at least one step");
+static_assert(SWEEP.step >= 1 && SWEEP.coarseStep >= SWEEP.step, "Coarse step must be at least the fine step");
+
+#endif
@@ -0,0 +1,59 @@
+// Timer1.cpp
+// Shared free-running Timer1 timebase
+
+#include <Arduino.h>
+#include <util/atomic.h>
+#include "Timer1.h"
+
+static bool timer1Running = false;
+
+// μs at the last wrap (see EXTENDED TIMEBASE)
+static volatile uint32_t wrapMicros = 0;
+
+#define WRAP_MICROS (65536UL / TIMER1_TICKS_PER_US)
+
+ISR(TIMER1_OVF_vect) {
+    wrapMicros += WRAP_MICROS;
+}
+
+void timer1Init() {
+    if (timer1Running) {
+        return;
+    }
+
+    // The Arduino core's init() sets Timer1 up for 8-bit PWM
+    // (analogWrite on D9/D10). We take it over completely.
+    TIMSK1 = (1 << TOIE1);      // Wrap count only until a channel arms its own
+    TCCR1A = 0;                 // Normal mode, OC1A/OC1B disconnected
+    TCCR1B = (1 << CS11);       // Prescaler 8 → 0.5μs per tick
+    TCNT1 = 0;
+    TIFR1 = 0xFF;               // Clear any stale flags
+
+    timer1Running = true;
+}
+
+// A wrap since interrupts went off shows as TOV1 still pending.
+// Read after it, TCNT1 is small; read just before it, the count
+// is near the top and the wrap is not ours yet.
+uint32_t timer1Micros() {
+    uint32_t base;
+    uint16_t ticks;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        base = wrapMicros;
+        ticks = TCNT1;
+        if ((TIFR1 & (1 << TOV1)) && ticks < 0x8000) {
+            base += WRAP_MICROS;
+        }
+    }
+    return base + ticks / TIMER1_TICKS_PER_US;
+}
+
+void timer1Stop() {
+    TCCR1B &= ~((1 << CS12) | (1 << CS11) | (1 << CS10));
+}
+
+void timer1Resume() {
+    if (timer1Running) {
+        TCCR1B |= (1 << CS11);
+    }
+}
@@ -0,0 +1,55 @@
+// Timer1.h
+// Shared Timer1 Timebase
+//
+// PURPOSE:
+// Timer1 is the only 16-bit timer on the ATmega328P. Three users
+// need it at the same time:
+//   - Ultrasonic: Input Capture on ICP1 (D8) to time the echo
+//   - ServoMotor: Output Compare on OC1A (D9) to generate the pulse
+//   - Ultrasonic: Output Compare B (no pin) as the range gate deadline
+// The overflow interrupt is a fourth (see EXTENDED TIMEBASE), and
+// DHTSensor and the extra sensors only read the counter.
+//
+// Instead of handing the timer back and forth (reconfiguring it
+// for each measurement), they all share one free-running counter.
+// Each user only touches its own channel's bits and interrupt.
+//
+// CONFIGURATION:
+//   - Normal mode (counts 0 → 65535 and wraps)
+//   - Prescaler 8: 16MHz / 8 = 2MHz → 0.5μs per tick
+//   - Wraps every 65536 × 0.5μs = 32.768ms
+//
+// Intervals shorter than one wrap are measured with plain uint16_t
+// subtraction, which handles the rollover automatically.
+//
+// EXTENDED TIMEBASE:
+// For timestamps the overflow interrupt counts wraps, so
+// timer1Micros() is a 32-bit μs clock like micros() - but read
+// from the same counter the echo is captured with, at 1μs rather
+// than Timer0's 4μs, and wrapping after 71 minutes. The overflow
+// ISR runs every 32.8ms for ~3μs. Like millis(), it does not
+// count while the unit sleeps (see Power.h).
+
+#ifndef TIMER1_H
+#define TIMER1_H
+
+#include "config.h"
+
+// Timer1 ticks per microsecond (prescaler 8 at 16MHz)
+#define TIMER1_TICKS_PER_US 2
+
+// Start the shared timebase. Safe to call more than once:
+// only the first call configures the hardware.
+void timer1Init();
+
+// Microseconds since timer1Init() (wraps, compare with signed
+// differences like micros()). Safe from ISRs.
+uint32_t timer1Micros();
+
+// Pause and resume the counter (low-power idle, see Power.h).
+// Every channel keeps its configuration; nothing that times with
+// Timer1 may be in flight while it is stopped.
+void timer1Stop();
+void timer1Resume();
+
+#endif
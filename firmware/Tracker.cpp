@@ -0,0 +1,92 @@
+// Tracker.cpp
+// Alpha-beta filter per angle
+
+#include <Arduino.h>
+#include "Tracker.h"
+#include "Ultrasonic.h"
+
+// Track.range value for "no track at this angle"
+#define TRACK_NONE 0x7FFF
+
+// One stamp tick = 64ms
+#define STAMP_SHIFT 6
+
+static uint16_t stampOf(unsigned long nowMs) {
+    return (uint16_t)(nowMs >> STAMP_SHIFT);
+}
+
+static int16_t clampSpeed(int32_t v) {
+    if (v > TRACK_MAX_SPEED) {
+        return TRACK_MAX_SPEED;
+    }
+    if (v < -TRACK_MAX_SPEED) {
+        return -TRACK_MAX_SPEED;
+    }
+    return (int16_t)v;
+}
+
+void Tracker::reset() {
+    for (uint8_t i = 0; i < TRACK_ANGLES; i++) {
+        tracks[i].range = TRACK_NONE;
+    }
+    current = &tracks[0];
+}
+
+uint16_t Tracker::update(int angle, uint16_t distanceMm, unsigned long nowMs) {
+    Track* t = &tracks[angle - SERVO_MIN_ANGLE];
+    current = t;
+
+    // UNTRACKED: no echo, beyond the gate, or too far to matter
+    // (DISTANCE_MM_INVALID and _BEYOND are both > TRACK_RANGE)
+    if (distanceMm > TRACK_RANGE) {
+        t->range = TRACK_NONE;
+        return distanceMm;
+    }
+
+    uint16_t stamp = stampOf(nowMs);
+    uint16_t age = stamp - t->stamp;    // Stamp ticks
+
+    if (t->range != TRACK_NONE && age <= (TRACK_MAX_AGE >> STAMP_SHIFT)) {
+        uint16_t dt = age << STAMP_SHIFT;   // ms, ≤ TRACK_MAX_AGE
+
+        // PREDICT AND COMPARE:
+        // |v| ≤ 1500mm/s and dt ≤ 20s, so both fit in int32 easily
+        int32_t predicted = t->range + (int32_t)t->velocity * dt / 1000;
+        int32_t residual = (int32_t)distanceMm - predicted;
+        int32_t gate = TRACK_GATE + (int32_t)TRACK_MAX_SPEED * dt / 1000;
+
+        if (residual <= gate && residual >= -gate) {
+            int32_t range = predicted + ((residual * TRACK_ALPHA) >> 8);
+            t->range = range < 0 ? 0 : (range > TRACK_RANGE ? TRACK_RANGE : (int16_t)range);
+            if (dt >= TRACK_MIN_DT) {
+                // β × residual / dt, in mm/s
+                int32_t dv = residual * TRACK_BETA * 1000 / ((int32_t)dt << 8);
+                t->velocity = clampSpeed(t->velocity + dv);
+            }
+            t->stamp = stamp;
+            return t->range;
+        }
+    }
+
+    // NEW TRACK: first reading here, stale, or a different object
+    t->range = distanceMm;
+    t->velocity = 0;
+    t->stamp = stamp;
+    return distanceMm;
+}
+
+int16_t Tracker::velocity() {
+    return current->range == TRACK_NONE ? 0 : current->velocity;
+}
+
+// TIME TO ARRIVAL:
+// range / closing speed. Anything slower than TRACK_MIN_APPROACH
+// (including noise on a static target) is not approaching.
+uint16_t Tracker::arrivalMs() {
+    int16_t v = velocity();
+    if (v > -TRACK_MIN_APPROACH) {
+        return ARRIVAL_NONE;
+    }
+    uint32_t ms = (uint32_t)current->range * 1000 / (uint16_t)(-v);
+    return ms >= ARRIVAL_NONE ? ARRIVAL_NONE - 1 : (uint16_t)ms;
+}
@@ -0,0 +1,103 @@
+// Tracker.h
+// Per-Angle Range Tracking Across Sweeps
+//
+// PURPOSE:
+// A sweep reports every angle on its own, so a receiver (and the
+// alert) sees sensor noise instead of a stable range, and cannot
+// tell a wall from something walking towards the sensor. The
+// tracker keeps a little state per angle and filters each new
+// reading against what that angle said on previous sweeps.
+//
+// ALPHA-BETA FILTER:
+// Each angle holds a range r (mm) and radial velocity v (mm/s).
+// A reading z taken dt after the last one updates them as:
+//
+//   predicted = r + v × dt
+//   residual  = z - predicted
+//   r = predicted + α × residual
+//   v = v + β × residual / dt
+//
+// α and β are Q8 fixed point; all arithmetic is integer. A fixed
+// gain pair is a steady-state Kalman filter for a constant-velocity
+// target - no covariance to store, so 6 bytes per angle.
+//
+// TRACK LIFETIME:
+//   - A reading beyond TRACK_RANGE, with no echo or beyond the
+//     range gate ends the track; the reading passes unfiltered.
+//   - A residual larger than the gate (TRACK_GATE plus what
+//     TRACK_MAX_SPEED could cover in dt) is a different object:
+//     the track restarts from the reading with v = 0.
+//   - A track not updated for TRACK_MAX_AGE restarts the same way.
+// TRACK_RANGE is ADAPTIVE_RANGE: an adaptive sweep always steps
+// fine through such angles, so live tracks are seen every sweep.
+//
+// TIMING:
+// Timestamps are millis() / 64 in two bytes, good for 70 minutes.
+// One byte would wrap every 16s, and an end angle is revisited up
+// to two sweeps apart - ~10s in the default room, more in a big
+// one or with priority sectors: a wrapped age would look fresh and
+// a stale track would be updated instead of restarted. For the
+// same reason TRACK_MAX_AGE allows two slow sweeps, so that every
+// visit, at the ends too, keeps its track.
+// Revisits closer together than TRACK_MIN_DT (an adaptive
+// backtrack, the end angle measured twice) refine r only; over
+// so short a dt the noise would swamp v. For the same reason a
+// new track starts at v = 0 rather than from its first two
+// readings: β brings a steady 0.1m/s approach in within about
+// five sweeps without inventing motion on static targets.
+//
+// LIMITS:
+// One filter per angle only sees radial motion. Something moving
+// across the beam shows up as a track ending at one angle and a
+// new one starting at the next.
+
+#ifndef TRACKER_H
+#define TRACKER_H
+
+#include "config.h"
+#include "Servo.h"
+
+// FILTER GAINS (Q8):
+// α = 0.5, β = 0.17 is the critically damped pair (β = α²/(2-α))
+#define TRACK_ALPHA 128
+#define TRACK_BETA  43
+
+#define TRACK_RANGE     ADAPTIVE_RANGE  // mm - farther readings are not tracked
+#define TRACK_GATE      150     // mm on top of the speed allowance
+#define TRACK_MAX_SPEED 1500    // mm/s - faster is a new object, and v is clamped here
+#define TRACK_MIN_DT    500     // ms - shorter revisits leave v alone
+#define TRACK_MAX_AGE   20000   // ms - older tracks restart (two full sweeps)
+
+// Arrival time for "not approaching"
+#define ARRIVAL_NONE 0xFFFF
+
+// Below this closing speed an object counts as standing still
+#define TRACK_MIN_APPROACH 50   // mm/s
+
+// One track per reported angle, as the delta frame buffer
+#define TRACK_ANGLES (SERVO_MAX_ANGLE - SERVO_MIN_ANGLE + 1)
+
+class Tracker {
+public:
+    void reset();               // Forget all tracks (scan start)
+
+    // Filter a reading at angle (degrees) taken at nowMs (millis()).
+    // Returns the filtered range, or the reading itself if it is
+    // not tracked (see TRACK LIFETIME).
+    uint16_t update(int angle, uint16_t distanceMm, unsigned long nowMs);
+
+    // Estimate for the angle last passed to update()
+    int16_t velocity();         // mm/s, negative = approaching, 0 if untracked
+    uint16_t arrivalMs();       // Until range reaches 0 at this speed, or ARRIVAL_NONE
+
+private:
+    struct Track {
+        int16_t range;          // mm, TRACK_NONE = no track
+        int16_t velocity;       // mm/s
+        uint16_t stamp;         // millis() / 64 of the last update
+    };
+    Track tracks[TRACK_ANGLES];
+    Track* current;             // Last updated
+};
+
+#endif
@@ -2,7 +2,10 @@
 // HC-SR04 driver with configurable speed of sound
 
 #include <Arduino.h>
+#include <util/atomic.h>
 #include "Ultrasonic.h"
+#include "Timer1.h"
+#include "SerialPort.h"
 
 // TIMEOUT CALCULATION:
 // Maximum distance is 400cm. At slowest reasonable speed of sound
@@ -11,6 +14,12 @@
 // We use 35ms timeout for safety margin.
 #define ECHO_TIMEOUT_MS 35
 
+// BUSY LINE:
+// How long a measurement waits for the previous ECHO pulse to end
+// before it is called stuck. The HC-SR04's miss pulse is ~38ms,
+// but some clones hold it for up to ~200ms.
+#define ECHO_LINE_TIMEOUT_MS 250
+
 // UNIT CONVERSION:
 // Speed of sound is in m/s, duration is in μs, we want cm.
 //   distance(cm) = duration(μs) × speed(m/s) × (100cm/1m) × (1s/1000000μs)
@@ -22,92 +31,376 @@
 // This allows hardware-assisted pulse timing, more accurate
 // than software polling used by pulseIn().
 //
-// Timer1 config: prescaler 8 → 0.5μs per tick at 16MHz
+// Timer1 runs free at 0.5μs per tick, shared with the servo
+// (see Timer1.h). We never reset or reconfigure it - only the
+// capture edge select (ICES1) and capture interrupt (ICIE1), plus
+// Output Compare B (OCR1B, OCIE1B) for the range gate.
 // Max measurable pulse: 65535 × 0.5μs = 32.7ms (enough for 400cm)
 
-void Ultrasonic::init() {
-    TRIG_DDR |= (1 << TRIG_BIT);    // TRIG as OUTPUT
-    ECHO_DDR &= ~(1 << ECHO_BIT);   // ECHO as INPUT (D8 = PB0)
-    TRIG_PORT &= ~(1 << TRIG_BIT);  // TRIG LOW
-    Serial.println(F("HC-SR04 initialized (Timer1 IC)"));
+static_assert(SENSOR_COUNT >= 1 && SENSOR_COUNT <= 3, "SENSOR_COUNT must be 1-3");
+
+void Ultrasonic::init(uint8_t sensor) {
+    channel = sensor;
+    busy = false;
+    echoValid = false;
+    echoBeyond = false;
+    gateTicks = 0;
+    echoFault = ECHO_FAULT_NONE;
+    tallied = true;
+    stuck = false;
+    memset(&counters, 0, sizeof(counters));
+    timer1Init();
+
+    if (channel == 0) {
+        TRIG_DDR |= (1 << TRIG_BIT);    // TRIG as OUTPUT
+        ECHO_DDR &= ~(1 << ECHO_BIT);   // ECHO as INPUT (D8 = PB0)
+        TRIG_PORT &= ~(1 << TRIG_BIT);  // TRIG LOW
+        serialPort.println(F("HC-SR04 initialized (Timer1 IC)"));
+        return;
+    }
+
+    TRIG_EXTRA_DDR |= (1 << TRIG_EXTRA_BIT(channel));
+    ECHO_EXTRA_DDR &= ~(1 << ECHO_EXTRA_BIT(channel));
+    TRIG_EXTRA_PORT &= ~(1 << TRIG_EXTRA_BIT(channel));
+    serialPort.print(F("HC-SR04 #"));
+    serialPort.print(channel + 1);
+    serialPort.println(F(" initialized (PCINT)"));
 }
 
-float Ultrasonic::getDistance(float soundSpeed) {
-    // SAVE TIMER1 STATE:
-    // Servo library also uses Timer1. We save its configuration
-    // and restore it after measurement. This works because
-    // servo.detach() is called before this function.
-    uint8_t tccr1a_save = TCCR1A;
-    uint8_t tccr1b_save = TCCR1B;
-    uint8_t timsk1_save = TIMSK1;
-    
-    // CONFIGURE TIMER1 FOR INPUT CAPTURE:
-    // - Normal mode (no PWM)
-    // - Prescaler 8: 16MHz / 8 = 2MHz → 0.5μs per tick
-    // - Rising edge detection first (ICES1 = 1)
-    // - Polling mode (no interrupts)
-    TCCR1A = 0;
-    TCCR1B = (1 << CS11) | (1 << ICES1);
-    TIMSK1 = 0;
-    TCNT1 = 0;
-    
-    // TRIGGER SEQUENCE (from datasheet):
-    // 1. Ensure trigger is LOW
-    // 2. Send HIGH pulse for at least 10μs
-    // 3. Sensor will emit 8 pulses at 40kHz
-    TRIG_PORT &= ~(1 << TRIG_BIT);
-    delayMicroseconds(2);
-
-    TRIG_PORT |= (1 << TRIG_BIT);
-    delayMicroseconds(12);
-    TRIG_PORT &= ~(1 << TRIG_BIT);
-    
-    // WAIT FOR RISING EDGE (pulse start):
-    // ICF1 flag is set when edge is captured
-    TIFR1 = (1 << ICF1);              // Clear flag by writing 1
-    uint32_t startWait = millis();
-    
-    while (!(TIFR1 & (1 << ICF1))) {
-        if (millis() - startWait > ECHO_TIMEOUT_MS) {
-            TCCR1A = tccr1a_save;     // Restore Timer1
-            TCCR1B = tccr1b_save;
-            TIMSK1 = timsk1_save;
-            return -1;                 // Timeout - no echo
+// ECHO CAPTURE STATE:
+// Shared between the ISRs and the main program, hence volatile.
+// The ISR walks WAIT_RISE → WAIT_FALL → DONE, storing the Timer1
+// count at each edge. One set per sensor.
+//   WAIT_LINE  previous pulse still high - watching for it to fall
+//   LINE_FREE  it fell; isReady() sends the trigger
+//   BEYOND     range gate expired before the falling edge
+enum EchoState : uint8_t {
+    ECHO_IDLE,
+    ECHO_WAIT_LINE,
+    ECHO_LINE_FREE,
+    ECHO_WAIT_RISE,
+    ECHO_WAIT_FALL,
+    ECHO_DONE,
+    ECHO_BEYOND
+};
+
+static volatile uint8_t echoState[SENSOR_COUNT];     // ECHO_IDLE = 0
+static volatile uint16_t echoStart[SENSOR_COUNT];
+static volatile uint16_t echoEnd[SENSOR_COUNT];
+
+// RANGE GATE:
+// One compare channel, so one gated echo at a time - sensors fire
+// one after another anyway (see SENSOR_STAGGER).
+static volatile uint16_t gate;          // Ticks for the echo in flight, 0 = off
+static volatile uint8_t gateChannel;
+
+// TRIGGER SEQUENCE (from datasheet):
+// 1. Ensure trigger is LOW
+// 2. Send HIGH pulse for at least 10μs
+// 3. Sensor will emit 8 pulses at 40kHz
+// ~14μs of busy-waiting, so never from an ISR and never with
+// interrupts off: the DHT11 times its edges in PCINT2 meanwhile.
+static void fire(uint8_t n) {
+    if (n == 0) {
+        TRIG_PORT &= ~(1 << TRIG_BIT);
+        delayMicroseconds(2);
+        TRIG_PORT |= (1 << TRIG_BIT);
+        delayMicroseconds(12);
+        TRIG_PORT &= ~(1 << TRIG_BIT);
+    } else {
+        TRIG_EXTRA_PORT &= ~(1 << TRIG_EXTRA_BIT(n));
+        delayMicroseconds(2);
+        TRIG_EXTRA_PORT |= (1 << TRIG_EXTRA_BIT(n));
+        delayMicroseconds(12);
+        TRIG_EXTRA_PORT &= ~(1 << TRIG_EXTRA_BIT(n));
+    }
+}
+
+// Start the gate when the echo rises (ISR context)
+static void armGate(uint8_t n, uint16_t rise) {
+    if (gate == 0) {
+        return;
+    }
+    gateChannel = n;
+    OCR1B = rise + gate;
+    TIFR1 = (1 << OCF1B);
+    TIMSK1 |= (1 << OCIE1B);
+}
+
+// GATE ISR:
+// Echo still high at rise + gate → the target is beyond the gate.
+// Stop watching the echo pin; the pulse is left to end by itself.
+ISR(TIMER1_COMPB_vect) {
+    TIMSK1 &= ~(1 << OCIE1B);
+    uint8_t n = gateChannel;
+    if (echoState[n] != ECHO_WAIT_FALL) {
+        return;
+    }
+    if (n == 0) {
+        TIMSK1 &= ~(1 << ICIE1);
+    } else {
+        PCMSK0 &= ~(1 << ECHO_EXTRA_BIT(n));
+    }
+    echoState[n] = ECHO_BEYOND;
+}
+
+// INPUT CAPTURE ISR:
+// Fires on each captured edge. ICR1 holds the hardware timestamp
+// latched at the exact moment of the edge, so ISR latency does not
+// affect accuracy - only that we read ICR1 before the next edge.
+ISR(TIMER1_CAPT_vect) {
+    if (echoState[0] == ECHO_WAIT_LINE) {
+        TIMSK1 &= ~(1 << ICIE1);        // Previous pulse over - isReady() triggers
+        echoState[0] = ECHO_LINE_FREE;
+    } else if (echoState[0] == ECHO_WAIT_RISE) {
+        echoStart[0] = ICR1;
+        TCCR1B &= ~(1 << ICES1);        // ICES1 = 0 → falling edge next
+        TIFR1 = (1 << ICF1);            // Changing edge may set ICF1 - clear it
+        echoState[0] = ECHO_WAIT_FALL;
+        armGate(0, echoStart[0]);
+    } else if (echoState[0] == ECHO_WAIT_FALL) {
+        echoEnd[0] = ICR1;
+        TIMSK1 &= ~((1 << ICIE1) | (1 << OCIE1B));  // Done - no more captures
+        echoState[0] = ECHO_DONE;
+    }
+}
+
+#if SENSOR_COUNT > 1
+// PIN CHANGE ISR (sensors 1...):
+// Fires on any edge of an enabled PORTB pin. TCNT1 is read first
+// thing so the timestamp is as close to the edge as we can get.
+// Each sensor's pin is only enabled while its echo is expected.
+ISR(PCINT0_vect) {
+    uint16_t now = TCNT1;
+    uint8_t pins = ECHO_EXTRA_PINR;
+
+    for (uint8_t n = 1; n < SENSOR_COUNT; n++) {
+        uint8_t mask = 1 << ECHO_EXTRA_BIT(n);
+        if (echoState[n] == ECHO_WAIT_LINE && !(pins & mask)) {
+            PCMSK0 &= ~mask;            // Previous pulse over - isReady() triggers
+            echoState[n] = ECHO_LINE_FREE;
+        } else if (echoState[n] == ECHO_WAIT_RISE && (pins & mask)) {
+            echoStart[n] = now;
+            echoState[n] = ECHO_WAIT_FALL;
+            armGate(n, now);
+        } else if (echoState[n] == ECHO_WAIT_FALL && !(pins & mask)) {
+            echoEnd[n] = now;
+            PCMSK0 &= ~mask;            // Done - stop watching this pin
+            if (gateChannel == n) {
+                TIMSK1 &= ~(1 << OCIE1B);
+            }
+            echoState[n] = ECHO_DONE;
         }
     }
-    uint16_t pulseStart = ICR1;        // Capture timestamp
-    
-    // SWITCH TO FALLING EDGE:
-    TCCR1B &= ~(1 << ICES1);           // ICES1 = 0 → falling edge
-    TIFR1 = (1 << ICF1);               // Clear flag
-    
-    // WAIT FOR FALLING EDGE (pulse end):
-    while (!(TIFR1 & (1 << ICF1))) {
-        if (millis() - startWait > ECHO_TIMEOUT_MS) {
-            TCCR1A = tccr1a_save;
-            TCCR1B = tccr1b_save;
-            TIMSK1 = timsk1_save;
-            return -1;
+}
+#endif
+
+// Convert the gate to ticks once, not per measurement:
+//   ticks = mm × 65536 / scale   (inverse of resultMm())
+void Ultrasonic::setRangeGate(uint16_t gateMm, uint16_t scale) {
+    if (gateMm == 0 || scale == 0) {
+        gateTicks = 0;
+        return;
+    }
+    uint32_t ticks = ((uint32_t)gateMm << 16) / scale;
+    gateTicks = ticks > 0xFFFF ? 0 : ticks;     // Beyond 32ms: no gate needed
+}
+
+bool Ultrasonic::lineHigh() {
+    if (channel == 0) {
+        return ECHO_PINR & (1 << ECHO_BIT);
+    }
+    return ECHO_EXTRA_PINR & (1 << ECHO_EXTRA_BIT(channel));
+}
+
+void Ultrasonic::startMeasurement() {
+    // STUCK LINE:
+    // Skip the sensor while it stays latched - no trigger, no wait.
+    if (stuck) {
+        if (lineHigh()) {
+            startTime = millis();
+            busy = true;
+            finish(ECHO_FAULT_STUCK);
+            return;
         }
+        stuck = false;              // Recovered: measure normally
     }
-    uint16_t pulseEnd = ICR1;
-    
-    // RESTORE TIMER1:
-    TCCR1A = tccr1a_save;
-    TCCR1B = tccr1b_save;
-    TIMSK1 = timsk1_save;
-    
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        gate = gateTicks;
+    }
+    busy = true;
+
+    // BUSY LINE:
+    // Watch for the previous pulse to end; the trigger goes out
+    // from isReady() once it has. The pin is checked after arming
+    // for the fall, so a fall in between is not missed.
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        echoState[channel] = ECHO_WAIT_LINE;
+        if (channel == 0) {
+            TCCR1B &= ~(1 << ICES1);    // Falling edge
+            TIFR1 = (1 << ICF1);        // Clear flag by writing 1
+            TIMSK1 |= (1 << ICIE1);
+        } else {
+            PCMSK0 |= (1 << ECHO_EXTRA_BIT(channel));
+            PCIFR = (1 << PCIF0);       // Clear stale flag
+            PCICR |= (1 << PCIE0);
+        }
+        if (!lineHigh()) {
+            echoState[channel] = ECHO_LINE_FREE;
+        }
+    }
+    startTime = millis();
+
+    if (echoState[channel] == ECHO_LINE_FREE) {
+        trigger();
+    }
+}
+
+// ARM, THEN FIRE:
+// The rising edge is armed first, so the trigger itself can run
+// with interrupts on - the echo cannot rise before the pulse is
+// over (~450μs after it). The echo timeout counts from here, not
+// from startMeasurement(): a wait for a busy line is not echo time.
+void Ultrasonic::trigger() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        echoState[channel] = ECHO_WAIT_RISE;
+        if (channel == 0) {
+            TCCR1B |= (1 << ICES1);     // Rising edge
+            TIFR1 = (1 << ICF1);
+            TIMSK1 |= (1 << ICIE1);
+        } else {
+            PCMSK0 |= (1 << ECHO_EXTRA_BIT(channel));
+            PCIFR = (1 << PCIF0);
+            PCICR |= (1 << PCIE0);
+        }
+    }
+    fire(channel);
+    startTime = millis();
+}
+
+bool Ultrasonic::isReady() {
+    if (!busy) {
+        return true;
+    }
+
+    uint8_t state = echoState[channel];
+    if (state == ECHO_LINE_FREE) {
+        trigger();
+        return false;
+    }
+    if (state == ECHO_WAIT_LINE) {
+        // Longer than any echo pulse: latched (see STUCK ECHO)
+        if (millis() - startTime > ECHO_LINE_TIMEOUT_MS) {
+            stuck = true;
+            finish(ECHO_FAULT_STUCK);
+            return true;
+        }
+        return false;
+    }
+    if (state == ECHO_DONE) {
+        finish(ECHO_FAULT_NONE);
+        return true;
+    }
+    if (state == ECHO_BEYOND) {
+        finish(ECHO_FAULT_BEYOND);
+        return true;
+    }
+
+    // TIMEOUT:
+    // Where the ISR got to tells the failures apart (see FAULT
+    // CODES). Read with the state above - an edge arriving in
+    // between only makes the verdict one edge stale.
+    if (millis() - startTime > ECHO_TIMEOUT_MS) {
+        if (state == ECHO_WAIT_RISE) {
+            finish(ECHO_FAULT_NO_RISE);
+        } else {
+            finish(ECHO_FAULT_NO_FALL);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+// Abandoned, not failed: kept out of the counters
+void Ultrasonic::cancel() {
+    if (busy) {
+        finish(ECHO_FAULT_NO_FALL);
+        tallied = true;
+    }
+}
+
+void Ultrasonic::finish(EchoFault outcome) {
+    // DISARM CAPTURE:
+    // Already masked by the ISR on success; needed after a timeout.
+    // Timer1 itself keeps running for the servo.
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (gateChannel == channel) {
+            TIMSK1 &= ~(1 << OCIE1B);
+        }
+        if (channel == 0) {
+            TIMSK1 &= ~(1 << ICIE1);
+        } else {
+            PCMSK0 &= ~(1 << ECHO_EXTRA_BIT(channel));
+            if (PCMSK0 == 0) {
+                PCICR &= ~(1 << PCIE0);
+            }
+        }
+        echoState[channel] = ECHO_IDLE;
+    }
+    busy = false;
+    echoValid = outcome == ECHO_FAULT_NONE;
+    echoBeyond = outcome == ECHO_FAULT_BEYOND;
+    echoFault = outcome;
+    tallied = false;
+
+    if (!echoValid) {
+        return;
+    }
+
     // CALCULATE PULSE DURATION:
     // Handle potential timer overflow during measurement
-    uint16_t ticks;
+    uint16_t pulseStart = echoStart[channel];
+    uint16_t pulseEnd = echoEnd[channel];
     if (pulseEnd >= pulseStart) {
-        ticks = pulseEnd - pulseStart;
+        echoTicks = pulseEnd - pulseStart;
     } else {
-        ticks = (65535 - pulseStart) + pulseEnd + 1;
+        echoTicks = (65535 - pulseStart) + pulseEnd + 1;
     }
-    
+}
+
+void Ultrasonic::tally(EchoFault outcome) {
+    echoFault = outcome;
+    if (tallied) {
+        return;
+    }
+    tallied = true;
+    counters.readings[outcome]++;
+
+    if (echoValid) {
+        uint8_t bucket = 0;
+        for (uint16_t width = echoTicks; width != 0; width >>= 1) {
+            bucket++;
+        }
+        if (counters.ticks[bucket] != 0xFFFF) {
+            counters.ticks[bucket]++;
+        }
+    }
+}
+
+float Ultrasonic::result(float soundSpeed) {
+    if (echoBeyond) {
+        tally(ECHO_FAULT_BEYOND);
+        return -2;                      // Nothing within the range gate
+    }
+    if (!echoValid) {
+        tally(echoFault);
+        return -1;                      // Timeout - no echo
+    }
+
     // Convert ticks to μs: ticks × 0.5μs/tick
-    float duration = ticks * 0.5f;
+    float duration = echoTicks * 0.5f;
     
     // DISTANCE FORMULA:
     //   distance = (duration × speed × unit_conversion) / 2
@@ -118,8 +411,92 @@ float Ultrasonic::getDistance(float soundSpeed) {
     
     // Validate against sensor's reliable range
     if (distance < MIN_DISTANCE || distance > MAX_DISTANCE) {
+        tally(distance < MIN_DISTANCE ? ECHO_FAULT_NEAR : ECHO_FAULT_FAR);
         return -1;
     }
     
+    tally(ECHO_FAULT_NONE);
+    return distance;
+}
+
+uint16_t Ultrasonic::resultMm(uint16_t scale) {
+    if (echoBeyond) {
+        tally(ECHO_FAULT_BEYOND);
+        return DISTANCE_MM_BEYOND;
+    }
+    if (!echoValid) {
+        tally(echoFault);
+        return DISTANCE_MM_INVALID;
+    }
+
+    // FIXED-POINT FORMULA:
+    //   distance(mm) = (ticks × scale) >> 16, rounded
+    // One 32-bit multiply and a shift replace the float chain above.
+    uint16_t distance = ((uint32_t)echoTicks * scale + 0x8000) >> 16;
+
+    if (distance < MIN_DISTANCE * 10 || distance > MAX_DISTANCE * 10) {
+        tally(distance < MIN_DISTANCE * 10 ? ECHO_FAULT_NEAR : ECHO_FAULT_FAR);
+        return DISTANCE_MM_INVALID;
+    }
+
+    tally(ECHO_FAULT_NONE);
     return distance;
-}
\ No newline at end of file
+}
+
+// RAW RESULT:
+// What resultMm() converts, for recording (see RAW_CAPTURE).
+// A width that would read as a code is clamped; it is far
+// beyond MAX_DISTANCE anyway.
+uint16_t Ultrasonic::resultTicks() {
+    if (echoBeyond) {
+        return ECHO_TICKS_BEYOND;
+    }
+    if (!echoValid) {
+        return ECHO_TICKS_NONE;
+    }
+    if (echoTicks == ECHO_TICKS_NONE) {
+        return 1;
+    }
+    return echoTicks == ECHO_TICKS_BEYOND ? ECHO_TICKS_BEYOND - 1 : echoTicks;
+}
+
+// BLOCKING MODE:
+// Same measurement, but spins until the echo is in.
+float Ultrasonic::getDistance(float soundSpeed) {
+    startMeasurement();
+    while (!isReady()) {
+    }
+    return result(soundSpeed);
+}
+
+uint16_t Ultrasonic::getDistanceMm(uint16_t scale) {
+    startMeasurement();
+    while (!isReady()) {
+    }
+    return resultMm(scale);
+}
+
+EchoFault Ultrasonic::fault() {
+    return echoFault;
+}
+
+bool Ultrasonic::isStuck() {
+    return stuck;
+}
+
+const EchoStats& Ultrasonic::stats() {
+    return counters;
+}
+
+const __FlashStringHelper* Ultrasonic::faultName(uint8_t fault) {
+    switch (fault) {
+        case ECHO_FAULT_NONE:    return F("valid");
+        case ECHO_FAULT_BEYOND:  return F("beyond");
+        case ECHO_FAULT_NO_RISE: return F("norise");
+        case ECHO_FAULT_NO_FALL: return F("nofall");
+        case ECHO_FAULT_NEAR:    return F("near");
+        case ECHO_FAULT_FAR:     return F("far");
+        case ECHO_FAULT_STUCK:   return F("stuck");
+        default:                 return F("?");
+    }
+}
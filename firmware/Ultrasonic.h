@@ -17,20 +17,163 @@
 //   - Accuracy: 3mm
 //   - Beam angle: 15 degrees
 //   - Measurement cycle: minimum 60ms between readings
+//
+// ASYNC MODE:
+// getDistance() blocks until the echo returns (up to 35ms).
+// The async API splits it in two so the caller can keep working
+// while the pulse is in flight:
+//   startMeasurement()  → fire trigger, arm Timer1 capture ISR
+//   isReady()           → poll; true once both edges seen or timed out
+//   result()            → distance of the finished measurement
+//
+// MULTIPLE SENSORS:
+// One Ultrasonic object per HC-SR04 (SENSOR_COUNT in config.h).
+// Sensor 0 uses Timer1 Input Capture on D8. There is only one
+// capture pin, so the others timestamp their echo edges in a
+// pin change interrupt by reading TCNT1 - same timebase, but a
+// few μs of interrupt latency (~1mm) instead of hardware-exact.
+//
+// RANGE GATE:
+// setRangeGate() limits how long to listen. When the echo rises,
+// Timer1 Output Compare B is set to "rise + gate"; if the echo is
+// still high then, the measurement ends right there with
+// DISTANCE_MM_BEYOND (-2 from the float API) instead of waiting
+// out the 35ms timeout. A 1500mm gate gives up after ~9ms.
+//
+// The HC-SR04 keeps ECHO high for up to ~38ms after a miss and
+// ignores triggers meanwhile. If the line is still high when the
+// next measurement starts, the ISR notes when it falls and
+// isReady() sends the trigger then; the 35ms echo timeout starts
+// with that trigger. So a gated miss frees the scanner early, but
+// the next ping still waits for the sensor's own ~38ms pulse:
+// the gate saves time on echoes that end between the gate and
+// 400cm, not on true misses.
+//
+// FAULT CODES:
+// The readings above say only "no distance"; fault() says why,
+// and every reading is counted by outcome in stats():
+//   NONE     valid echo within the sensor's range
+//   BEYOND   still on at the range gate (not a fault as such)
+//   NO_RISE  the echo never started: sensor silent or unplugged
+//   NO_FALL  the echo never ended in 35ms: nothing in range (the
+//            HC-SR04's own miss pulse is ~38ms)
+//   NEAR     shorter than MIN_DISTANCE
+//   FAR      longer than MAX_DISTANCE
+//   STUCK    ECHO high since before the trigger (below)
+// A reading counts once, when its result is read. Captured widths
+// (NONE, NEAR, FAR) also go into a log2 histogram of raw Timer1
+// ticks: bucket n holds [2^(n-1), 2^n), so the 2cm minimum (~230
+// ticks) is bucket 8 and the 400cm limit (~47000) bucket 16. Widths
+// below bucket 8 are ringing or crosstalk, not targets.
+//
+// STUCK ECHO:
+// A line that is high at the trigger and still high 250ms later
+// has outlasted any echo pulse, even from slow clones. From then on the
+// sensor is marked stuck: measurements check the pin and, while it
+// is still high, end at once with STUCK instead of costing another
+// timeout. The driver cannot free the line: ECHO is a push-pull
+// output, and a latched clone only recovers when its VCC is cut,
+// which needs a power-switched sensor supply this board does not
+// have. The first trigger that finds the line low clears the mark,
+// so the scan is back to full rate as soon as the sensor is.
 
 #ifndef ULTRASONIC_H
 #define ULTRASONIC_H
 
 #include "config.h"
+#include "Hal.h"
 
 // HC-SR04 sensor limits (from datasheet)
 #define MIN_DISTANCE 2          // Minimum distance in cm
 #define MAX_DISTANCE 400        // Maximum distance in cm
 
-class Ultrasonic {
+// Minimum time between triggers (datasheet measurement cycle),
+// so an echo from the previous ping cannot be mistaken for ours
+#define MIN_PING_INTERVAL 60    // ms
+
+// The datasheet cycle covers the worst case: a 38ms miss plus
+// margin. What matters is that the last ping has died out, so the
+// scanner counts from the end of the previous echo (or its timeout)
+// instead. An echo cannot end before its trigger, so the next
+// trigger is also at least this long after the previous one - more
+// than the 23.3ms round trip to MAX_DISTANCE; later reflections
+// come from beyond the sensor's range. After a timeout it comes to
+// the same ~60ms as MIN_PING_INTERVAL.
+#define PING_QUIET_TIME 25      // ms
+
+// Returned by the millimetre API when there is no valid reading
+#define DISTANCE_MM_INVALID 0xFFFF
+
+// Returned when the echo was still on at the range gate:
+// nothing nearer than the gate, but not necessarily nothing at all
+#define DISTANCE_MM_BEYOND 0xFFFE
+
+// Same outcomes for the raw echo width from resultTicks()
+#define ECHO_TICKS_NONE   0
+#define ECHO_TICKS_BEYOND 0xFFFF
+
+// Why the last reading has no distance (see FAULT CODES)
+enum EchoFault : uint8_t {
+    ECHO_FAULT_NONE,
+    ECHO_FAULT_BEYOND,
+    ECHO_FAULT_NO_RISE,
+    ECHO_FAULT_NO_FALL,
+    ECHO_FAULT_NEAR,
+    ECHO_FAULT_FAR,
+    ECHO_FAULT_STUCK,
+    ECHO_FAULTS
+};
+
+#define ECHO_TICK_BUCKETS 17     // 0, then one per bit of a 16-bit width
+
+struct EchoStats {
+    uint32_t readings[ECHO_FAULTS];     // By fault code, NONE = valid
+    uint16_t ticks[ECHO_TICK_BUCKETS];  // Captured widths, saturating
+};
+
+class Ultrasonic : public RangeSensor {
 public:
-    void init();
-    float getDistance(float soundSpeed);    // Returns distance in cm, or -1 if invalid
+    void init(uint8_t sensor = 0);  // 0: D2/D8, 1...: see config.h
+    float getDistance(float soundSpeed);    // Returns distance in cm, -1 if invalid, -2 beyond gate
+
+    void startMeasurement() override;       // Trigger and return immediately
+    bool isReady() override;                // True when echo captured or timed out
+    void cancel() override;                 // Abandon a measurement in flight
+    float result(float soundSpeed);         // Same codes as getDistance()
+
+    // FIXED-POINT API:
+    // scale from calculateDistanceScale() (see SpeedOfSound.h).
+    // Returns distance in mm, DISTANCE_MM_INVALID or DISTANCE_MM_BEYOND.
+    uint16_t getDistanceMm(uint16_t scale);
+    uint16_t resultMm(uint16_t scale) override;
+    uint16_t resultTicks() override;        // Timer1 ticks (0.5μs), before any scaling
+
+    // Listen for echoes up to gateMm only (0 = full range).
+    // scale converts it to Timer1 ticks - call again when it changes.
+    void setRangeGate(uint16_t gateMm, uint16_t scale) override;
+
+    EchoFault fault();              // Last reading's outcome
+    bool isStuck();                 // ECHO line latched high
+    const EchoStats& stats();       // Since init()
+    static const __FlashStringHelper* faultName(uint8_t fault);
+
+private:
+    uint8_t channel;                // Which HC-SR04 (0 = Input Capture)
+    bool busy;                      // Measurement in flight?
+    bool echoValid;                 // Both edges captured before timeout
+    bool echoBeyond;                // Still on at the range gate
+    uint16_t gateTicks;             // Range gate in Timer1 ticks, 0 = off
+    uint16_t echoTicks;             // Pulse width in Timer1 ticks (0.5μs)
+    unsigned long startTime;        // millis() at trigger (or start of the line wait)
+    EchoFault echoFault;
+    bool tallied;                   // Last reading already in counters
+    bool stuck;
+    EchoStats counters;
+
+    bool lineHigh();
+    void trigger();                 // Arm the rising edge and fire
+    void finish(EchoFault outcome); // Disarm capture and latch the result
+    void tally(EchoFault outcome);  // Settle fault() and count it, once
 };
 
 #endif
\ No newline at end of file
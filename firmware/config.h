@@ -21,24 +21,271 @@ static constexpr uint8_t ECHO_PIN = 8;
 
 // Direct port manipulation for ECHO (D8 = PORTB bit 0)
 #define ECHO_DDR  DDRB
+#define ECHO_PINR PINB
 #define ECHO_BIT  0
 
+// Additional HC-SR04s (SENSOR_COUNT > 1, see MULTIPLE SENSORS)
+static constexpr uint8_t TRIG_PIN_2 = 14;   // A0
+static constexpr uint8_t ECHO_PIN_2 = 10;
+static constexpr uint8_t TRIG_PIN_3 = 15;   // A1
+static constexpr uint8_t ECHO_PIN_3 = 11;
+
+// Direct port manipulation for sensor n = 1, 2 (0 is the one above)
+// TRIG: A0/A1 = PORTC bit n-1
+// ECHO: D10/D11 = PORTB bit n+1 = PCINT2/PCINT3 (pin change
+//       interrupt group 0 - no Input Capture pin left for them)
+#define TRIG_EXTRA_PORT PORTC
+#define TRIG_EXTRA_DDR  DDRC
+#define TRIG_EXTRA_BIT(n) ((n) - 1)
+#define ECHO_EXTRA_DDR  DDRB
+#define ECHO_EXTRA_PINR PINB
+#define ECHO_EXTRA_BIT(n) ((n) + 1)
+
 static constexpr uint8_t SERVO_PIN = 9;     // Servo Motor SG90
 
+// Direct port manipulation for SERVO (D9 = PORTB bit 1 = OC1A)
+// Fixed: the pulse is generated by Timer1's Output Compare A pin
+#define SERVO_PORT PORTB
+#define SERVO_DDR  DDRB
+#define SERVO_BIT  1
+
 static constexpr uint8_t DHT_PIN = 4;       // Temperature & Humidity Sensor DHT11
 
+// Direct port manipulation for DHT (D4 = PORTD bit 4 = PCINT20)
+#define DHT_PORT PORTD
+#define DHT_DDR  DDRD
+#define DHT_PINR PIND
+#define DHT_BIT  4
+
 static constexpr uint8_t BUZZER_PIN = 3;    // Passive Buzzer
+// Fixed: the tone is generated by Timer2's Output Compare B pin (OC2B)
 
 static constexpr uint8_t LED_PIN = 13;      // Red LED
 
 static constexpr uint8_t BUTTON_PIN = 6;    // Button
 
+// Direct port manipulation for BUTTON (D6 = PORTD bit 6 = PCINT22)
+// Shares the PCINT2 vector with the DHT (see DHTSensor.cpp)
+#define BUTTON_PINR PIND
+#define BUTTON_BIT  6
+
 // ============================================
 // TIMING CONSTANTS
 // ============================================
 
 static constexpr uint32_t SERIAL_BAUD = 115200;
 
+// Serial ring buffer sizes (bytes, power of two, max 256).
+// At 115200 baud, 256 bytes drain in ~22ms - several sweep
+// steps of output can queue without stalling the scan.
+#define SERIAL_TX_BUFFER_SIZE 256
+#define SERIAL_RX_BUFFER_SIZE 32
+
+// ============================================
+// OUTPUT FORMAT
+// ============================================
+// OUTPUT_CSV:    one text line per sample, a SWEEP line per sweep
+//                (see Scanner.h)
+// OUTPUT_BINARY: compact CRC-checked frames (see Protocol.h)
+
+#define OUTPUT_CSV    0
+#define OUTPUT_BINARY 1
+
+#define OUTPUT_FORMAT OUTPUT_CSV
+
+// ============================================
+// SWEEP PROFILE
+// ============================================
+// Sweep range and step sizes (see SweepConfig.h):
+//   SWEEP_WIDE_FINE    10°-170° in 1° steps (default)
+//   SWEEP_NARROW_FAST  50°-130° in 2° steps
+// The profile sizes the per-angle buffers and the servo pulse table,
+// the only table precomputed from it; settle times and the step
+// sequence are still worked out at runtime.
+
+#define SWEEP_PROFILE SWEEP_WIDE_FINE
+
+// ============================================
+// DELTA OUTPUT
+// ============================================
+// Scanner remembers the last distance sent for every angle and
+// only transmits an angle again when it changed by more than
+// DELTA_DEADBAND mm. Every KEYFRAME_INTERVAL sweeps all angles
+// are sent so the receiver can resynchronize.
+// Costs 2 bytes of SRAM per angle (322 bytes for 10°-170°).
+
+#define ENABLE_DELTA_OUTPUT 1
+#define DELTA_DEADBAND      20      // mm
+#define KEYFRAME_INTERVAL   10      // sweeps (one direction = one sweep)
+
+// ============================================
+// SEGMENT OUTPUT
+// ============================================
+// Binary output only: group consecutive samples whose distances
+// differ by at most SEGMENT_GAP mm into segments, and send one
+// SEGMENT frame per object instead of a SAMPLE frame per angle
+// (see Protocol.h). Link load then follows the number of objects,
+// not the sweep resolution. CSV output is unaffected.
+// Costs 11 bytes of SRAM per sensor.
+// (The host checks build a variant with this on; see host/check.)
+
+#ifndef ENABLE_SEGMENT_OUTPUT
+#define ENABLE_SEGMENT_OUTPUT 0
+#endif
+#define SEGMENT_GAP           100   // mm between neighbours of one object
+
+// ============================================
+// ADAPTIVE SWEEP
+// ============================================
+// Step the profile's coarse step at a time while nothing is
+// within ADAPTIVE_RANGE, and its fine step near echoes seen in this
+// or the previous sweep. When a coarse step lands on a target,
+// the scanner backtracks to find its edge at full resolution.
+// Keyframe sweeps always run at full resolution.
+// Costs 1 bit of SRAM per angle (21 bytes for 10°-170°).
+
+#define ENABLE_ADAPTIVE_SWEEP 1
+#define ADAPTIVE_RANGE        2000  // mm - echoes beyond this count as empty
+
+// ============================================
+// MULTI-PING
+// ============================================
+// Take up to PINGS_PER_ANGLE readings per angle and report the
+// median. Stops early as soon as two readings agree within
+// PING_AGREEMENT mm (two timeouts also agree), so most angles
+// need two pings. Every ping, repeat or new angle, waits until
+// PING_QUIET_TIME (25ms) after the sensor's previous echo ended:
+// ~40ms trigger to trigger for a wall at 2m, the 60ms datasheet
+// cycle after a miss. A single-ping 10°-170° sweep takes ~4.9s in
+// the default simulator room (~3.2s with no spacing at all), ~3.0s
+// with a 1500mm RANGE_GATE.
+// 1 = single ping (fastest sweep); 3 filters spikes and dropouts.
+// (The host checks build a variant with 3; see host/check.)
+
+#ifndef PINGS_PER_ANGLE
+#define PINGS_PER_ANGLE 1
+#endif
+#define PING_AGREEMENT  10      // mm
+
+// ============================================
+// TRACKING
+// ============================================
+// Filter each angle's readings across sweeps with an alpha-beta
+// filter (see Tracker.h): steadier ranges plus a radial velocity.
+// Output carries the filtered range; binary output sends TRACK
+// frames with the velocity instead of SAMPLE frames (CSV has no
+// velocity column). The alert also reacts to how soon an
+// approaching object arrives, not only to how near it is.
+// Costs 6 bytes of SRAM per angle (966 bytes for 10°-170°).
+
+#define ENABLE_TRACKING 0
+
+// ============================================
+// PRIORITY SECTORS
+// ============================================
+// Revisit chosen sectors more often than a full sweep allows.
+// After every PRIORITY_CHUNK degrees of the sweep the servo swings
+// over to each sector in turn, sweeps it once, and carries on from
+// where it left (see Scanner.h). Up to PRIORITY_SECTORS are set
+// over serial (SECTOR command); SECTOR AUTO adds one more around
+// the nearest echo within PRIORITY_AUTO_RANGE of the last sweep.
+// No sectors set (the default) = plain sweeps, as before.
+// Costs 2 bytes of SRAM per sector plus about 16.
+
+#define ENABLE_PRIORITY_SECTORS 1
+#define PRIORITY_SECTORS     2
+#define PRIORITY_CHUNK       30     // degrees of sweep between visits
+#define PRIORITY_AUTO_RANGE  1000   // mm
+#define PRIORITY_AUTO_MARGIN 10     // degrees either side of the echo
+
+// The servo settle model uses the SG90's unloaded datasheet speed.
+// Over a 1° step the shortfall disappears in the base time, over a
+// long swing to a sector it adds up; this much extra per degree
+// of swing keeps the first ping from firing on the way.
+#define PRIORITY_SWING_MARGIN 400    // μs per degree
+
+// ============================================
+// RANGE GATE
+// ============================================
+// Stop listening for an echo beyond RANGE_GATE mm (see
+// Ultrasonic.h) and report "beyond" instead of waiting for the
+// 400cm timeout. 1500 covers the alert zone and ends the wait for
+// a far echo after ~9ms. A true miss gains little: the sensor
+// holds ECHO high for ~38ms and the next trigger waits for that.
+// 0 = full range.
+
+#define RANGE_GATE 0            // mm
+
+// ============================================
+// RAW CAPTURE
+// ============================================
+// Binary output only: also send a RAW frame for every ping - the
+// echo width in Timer1 ticks before any conversion, the trigger
+// time and the distance scale in use (see Protocol.h). A capture
+// of the serial stream can then be replayed through Scanner on a
+// PC (host/replay). 14 bytes per ping, ~2KB per full sweep.
+
+#define RAW_CAPTURE 0
+
+// ============================================
+// TIMESTAMPS
+// ============================================
+// Stamp every sample with its trigger time in μs from the 32-bit
+// extended Timer1 clock (see Timer1.h), so a receiver can line
+// samples up with other systems and see how stale each one is.
+// CSV gains a sixth column; binary output sends an 8-byte TIME
+// frame ahead of each sample (see Protocol.h).
+
+#define ENABLE_TIMESTAMPS 0
+
+// ============================================
+// MULTIPLE SENSORS
+// ============================================
+// Up to 3 HC-SR04s on the servo horn, each SENSOR_SPACING degrees
+// further round than the previous one. The servo then only travels
+// SERVO_MIN_ANGLE to SERVO_MAX_ANGLE - (SENSOR_COUNT-1) × SPACING
+// while the sensors together still cover the full range; samples
+// are reported at the angle each sensor was pointing.
+//
+// Two sensors 80° apart halve the servo travel (10°-90°);
+// three need SENSOR_SPACING 53 or less to leave no gaps.
+//
+// CROSSTALK:
+// Sensors fire one at a time. The next one triggers SENSOR_STAGGER
+// after the previous sensor's echo (or timeout), so reflections of
+// that ping from beyond its first echo have faded before it
+// listens. Each ms here costs ~1ms per step; raise it if
+// readings jump in a reverberant room (25ms + echo ≈ 8m of travel).
+
+#define SENSOR_COUNT   1
+#define SENSOR_SPACING 80       // degrees between mounts
+#define SENSOR_STAGGER 5        // ms from one sensor's echo to the next trigger
+
+// ============================================
+// LOW-POWER IDLE
+// ============================================
+// While not scanning, park and detach the servo and sleep until
+// the button or serial RX wakes the unit (see Power.h).
+// SLEEP_MODE_PWR_DOWN saves most but loses the waking serial byte;
+// SLEEP_MODE_IDLE keeps the UART (and millis()) running.
+// After a wake the unit stays up IDLE_WAKE_WINDOW for commands.
+
+#define ENABLE_IDLE_SLEEP 1
+#define IDLE_SLEEP_MODE   SLEEP_MODE_PWR_DOWN
+#define IDLE_WAKE_WINDOW  2000      // ms
+
+// ============================================
+// PROFILING
+// ============================================
+// Profiling build: time each scan stage with micros() and keep
+// min/mean/max plus a log2 histogram per stage (see Profile.h),
+// including each sample's latency from trigger to the UART.
+// Report is printed at the end of every sweep and when 'P' is
+// received on serial. Costs ~300 bytes of SRAM; keep 0 for
+// normal builds (the hooks then compile to nothing).
+
+#define ENABLE_PROFILE 0
+
 // ============================================
 // STRUCTS
 // ============================================
@@ -48,6 +295,8 @@ typedef struct {
     float humidity;       // Relative humidity (%)
     float temperatureC;   // Temperature in Celsius
     float temperatureF;   // Temperature in Fahrenheit
+    int16_t temperatureC10; // Same in tenths of °C, straight from the sensor
+    uint8_t humidityRH;   // Same rounded to whole % (DHT11 resolution)
     bool valid;           // Reading successful flag
 } THReading;
 
@@ -2,7 +2,7 @@
 // SIREN - Sonic Imaging for Range Exploration and Navigation
 //
 // Main entry point for the ultrasonic radar system.
-// Coordinates all components and implements the state machine.
+// Coordinates all components as cooperative scheduler tasks.
 //
 // SYSTEM OVERVIEW:
 // 1. User presses button to start scanning
@@ -12,18 +12,29 @@
 // 5. Alert activates if objects detected within 100cm
 // 6. Data transmitted via serial in CSV format
 // 7. User presses button again to stop
+// 8. Idle: servo parked, CPU asleep until button or serial (Power.h)
+// 9. Serial commands adjust sweep, alert and output live, and
+//    SAVE keeps them in EEPROM (see SERIAL COMMANDS, Settings.h)
 //
 // SERIAL OUTPUT FORMAT:
 // 115200 baud, CSV: angle,distance,humidity,tempC,tempF
+// or binary frames when OUTPUT_FORMAT is OUTPUT_BINARY (see Protocol.h)
 //
 // HARDWARE CONNECTIONS: See config.h and docs/hardware.md
 
 #include "Alert.h"
 #include "Button.h"
+#include "CommandLine.h"
 #include "config.h"
 #include "DHTSensor.h"
+#include "Memory.h"
+#include "Power.h"
+#include "Profile.h"
 #include "Scanner.h"
+#include "Scheduler.h"
+#include "SerialPort.h"
 #include "Servo.h"
+#include "Settings.h"
 #include "SpeedOfSound.h"
 #include "Ultrasonic.h"
 
@@ -31,8 +42,8 @@
 // GLOBAL OBJECTS
 // ===========================================
 
-// Sensor instances
-Ultrasonic ultrasonic;
+// Sensor instances (one per HC-SR04, see SENSOR_COUNT)
+Ultrasonic ultrasonic[SENSOR_COUNT];
 DHTSensor dht;
 
 // Actuator instances
@@ -44,12 +55,394 @@ Button button;
 
 // Scanner orchestrator - receives pointers to all components
 // This is dependency injection pattern
-Scanner scanner(&ultrasonic, &servo, &alert, &button);
+Scanner scanner(&ultrasonic[0], &servo, &alert);
 
-// STATE MACHINE:
-// Simple two-state machine: scanning or idle
-// Controlled by button press (toggle)
-bool scanning = false;
+// Cooperative scheduler - runs the tasks below from the main loop
+Scheduler scheduler;
+
+// Serial command input and the parameters it edits
+CommandLine commandLine;
+Settings settings;
+
+// ===========================================
+// TASKS
+// ===========================================
+// Each task does a little work and returns; none of them block.
+
+// How often the environment task advances the DHT state machine.
+// Short enough to end the 20ms start signal on time; DHTSensor
+// itself limits transactions to one per 2 seconds.
+#define ENVIRONMENT_TASK_INTERVAL 5     // ms
+
+static void printHeader() {
+    if (scanner.getOutputFormat() == OUTPUT_CSV) {
+        serialPort.println(F("angle,distance,humidity,temperatureC,temperatureF"));
+    }
+}
+
+static void startScan() {
+#if ENABLE_IDLE_SLEEP
+    servo.attach();             // Parked at SERVO_MIN_ANGLE
+#endif
+    serialPort.println(F("SCAN STARTED"));
+    // Print CSV header when starting
+    printHeader();
+    scanner.start();
+}
+
+static void stopScan() {
+    // Stop alert when stopping
+    scanner.stop();
+    serialPort.println(F("SCAN STOPPED"));
+}
+
+// STATE TOGGLE:
+// Check for button press and toggle scanning state
+static void buttonTask() {
+    if (!button.isPressed()) {
+        return;
+    }
+
+    if (!scanner.isScanning()) {
+        startScan();
+    } else {
+        stopScan();
+    }
+}
+
+static uint16_t reportObject(const __FlashStringHelper* name, uint16_t bytes) {
+    memoryReportItem(name, bytes);
+    return bytes;
+}
+
+// MEMORY REPORT:
+// Every global object, then the totals (see Memory.h).
+// The DHT11 driver is our own, so there is no separate DHT
+// library object; file-scope driver state shows up in "other".
+static void memoryReport() {
+    uint16_t objects = 0;
+    objects += reportObject(F("scanner"), sizeof(scanner));
+    objects += reportObject(F("serial"), sizeof(serialPort));      // TX + RX rings
+    objects += reportObject(F("ultrasonic"), sizeof(ultrasonic));  // All sensors
+    objects += reportObject(F("dht"), sizeof(dht));
+    objects += reportObject(F("alert"), sizeof(alert));
+    objects += reportObject(F("servo"), sizeof(servo));
+    objects += reportObject(F("button"), sizeof(button));
+    objects += reportObject(F("scheduler"), sizeof(scheduler));
+    objects += reportObject(F("command"), sizeof(commandLine));
+    objects += reportObject(F("settings"), sizeof(settings));
+    memoryReportTotals(objects);
+}
+
+// ECHO REPORT:
+// Per sensor, readings by outcome (see FAULT CODES in
+// Ultrasonic.h) and whether the line is latched high now, then
+// the echo width histogram:
+//   ECHO,<sensor>,<outcome>,<count>
+//   ECHO,<sensor>,ticks,<bucket 0>,...,<bucket 16>
+static void reportEchoItem(uint8_t n, const __FlashStringHelper* name, uint32_t count) {
+    serialPort.print(F("ECHO,"));
+    serialPort.print(n);
+    serialPort.print(',');
+    serialPort.print(name);
+    serialPort.print(',');
+    serialPort.println(count);
+}
+
+static void echoReport() {
+    for (uint8_t n = 0; n < SENSOR_COUNT; n++) {
+        const EchoStats& stats = ultrasonic[n].stats();
+        for (uint8_t fault = 0; fault < ECHO_FAULTS; fault++) {
+            reportEchoItem(n, Ultrasonic::faultName(fault), stats.readings[fault]);
+        }
+        reportEchoItem(n, F("latched"), ultrasonic[n].isStuck());
+
+        serialPort.print(F("ECHO,"));
+        serialPort.print(n);
+        serialPort.print(F(",ticks"));
+        for (uint8_t b = 0; b < ECHO_TICK_BUCKETS; b++) {
+            serialPort.print(',');
+            serialPort.print(stats.ticks[b]);
+        }
+        serialPort.println();
+    }
+}
+
+// LIVE SETTINGS:
+// One path for boot and commands: push the whole record to the
+// components. Each setter is cheap and safe mid-sweep.
+static void applySettings() {
+    scanner.setSweep(settings.sweepMin, settings.sweepMax, settings.step);
+    scanner.setRangeGate(settings.gateMm);
+    scanner.setOutputFormat(settings.format);
+    servo.setSettleBase(settings.settleUs);
+    alert.setThresholds(settings.warnMm, settings.dangerMm);
+#if ENABLE_PRIORITY_SECTORS
+    for (uint8_t i = 0; i < PRIORITY_SECTORS; i++) {
+        scanner.setSector(i, settings.sectorFirst[i], settings.sectorLast[i]);
+    }
+    scanner.setAutoSector(settings.sectorAuto);
+#endif
+}
+
+static void reportSetting(const __FlashStringHelper* key, uint16_t value) {
+    serialPort.print(F("CONFIG,"));
+    serialPort.print(key);
+    serialPort.print(',');
+    serialPort.println(value);
+}
+
+static void reportSetting(const __FlashStringHelper* key, uint16_t first, uint16_t second) {
+    serialPort.print(F("CONFIG,"));
+    serialPort.print(key);
+    serialPort.print(',');
+    serialPort.print(first);
+    serialPort.print(',');
+    serialPort.println(second);
+}
+
+static void reportSettings() {
+    reportSetting(F("range"), settings.sweepMin, settings.sweepMax);
+    reportSetting(F("step"), settings.step);
+    reportSetting(F("settle"), settings.settleUs);
+    reportSetting(F("alert"), settings.warnMm, settings.dangerMm);
+    reportSetting(F("gate"), settings.gateMm);
+    serialPort.println(settings.format == OUTPUT_BINARY ? F("CONFIG,format,BIN") : F("CONFIG,format,CSV"));
+#if ENABLE_PRIORITY_SECTORS
+    for (uint8_t i = 0; i < PRIORITY_SECTORS; i++) {
+        if (settings.sectorFirst[i] != SECTOR_NONE) {
+            reportSetting(F("sector"), settings.sectorFirst[i], settings.sectorLast[i]);
+        }
+    }
+    if (settings.sectorAuto) {
+        serialPort.println(F("CONFIG,sector,AUTO"));
+    }
+#endif
+}
+
+#if ENABLE_PRIORITY_SECTORS
+// SECTOR first last takes the first free slot
+static bool addSector(Settings* edited, uint16_t first, uint16_t last) {
+    for (uint8_t i = 0; i < PRIORITY_SECTORS; i++) {
+        if (edited->sectorFirst[i] == SECTOR_NONE) {
+            edited->sectorFirst[i] = first;
+            edited->sectorLast[i] = last;
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+// SETTING COMMANDS:
+// Edit a copy, and only adopt it if every field is still valid
+// (Settings.h) - a bad value never reaches the scanner.
+// Angles and steps above 180 are refused before they are
+// narrowed to a byte.
+static bool editSettings() {
+    Settings edited = settings;
+    uint16_t a, b;
+    uint8_t args = commandLine.count() - 1;
+
+    if (commandLine.is(0, PSTR("RANGE")) && args == 2 &&
+        commandLine.number(1, &a) && commandLine.number(2, &b) && a <= 180 && b <= 180) {
+        edited.sweepMin = a;
+        edited.sweepMax = b;
+    } else if (commandLine.is(0, PSTR("STEP")) && args == 1 && commandLine.number(1, &a) && a <= 180) {
+        edited.step = a;
+    } else if (commandLine.is(0, PSTR("SETTLE")) && args == 1 && commandLine.number(1, &a)) {
+        edited.settleUs = a;
+    } else if (commandLine.is(0, PSTR("ALERT")) && args == 2 &&
+               commandLine.number(1, &a) && commandLine.number(2, &b)) {
+        edited.warnMm = a;
+        edited.dangerMm = b;
+    } else if (commandLine.is(0, PSTR("GATE")) && args == 1 && commandLine.number(1, &a)) {
+        edited.gateMm = a;
+    } else if (commandLine.is(0, PSTR("FORMAT")) && args == 1 && commandLine.is(1, PSTR("CSV"))) {
+        edited.format = OUTPUT_CSV;
+    } else if (commandLine.is(0, PSTR("FORMAT")) && args == 1 && commandLine.is(1, PSTR("BIN"))) {
+        edited.format = OUTPUT_BINARY;
+#if ENABLE_PRIORITY_SECTORS
+    } else if (commandLine.is(0, PSTR("SECTOR")) && args == 2 &&
+               commandLine.number(1, &a) && commandLine.number(2, &b) && a <= 180 && b <= 180) {
+        if (!addSector(&edited, a, b)) {
+            return false;       // All slots taken
+        }
+    } else if (commandLine.is(0, PSTR("SECTOR")) && args == 1 && commandLine.is(1, PSTR("AUTO"))) {
+        edited.sectorAuto = 1;
+    } else if (commandLine.is(0, PSTR("SECTOR")) && args == 1 && commandLine.is(1, PSTR("CLEAR"))) {
+        for (uint8_t i = 0; i < PRIORITY_SECTORS; i++) {
+            edited.sectorFirst[i] = SECTOR_NONE;
+        }
+        edited.sectorAuto = 0;
+#endif
+    } else if (commandLine.is(0, PSTR("DEFAULTS")) && args == 0) {
+        settingsDefaults(&edited);
+    } else {
+        return false;
+    }
+
+    if (!settingsValid(&edited)) {
+        return false;
+    }
+    bool toCsv = edited.format == OUTPUT_CSV && settings.format != OUTPUT_CSV;
+    settings = edited;
+    applySettings();
+    if (toCsv && scanner.isScanning()) {
+        printHeader();          // Receiver switches mid-scan
+    }
+    return true;
+}
+
+// SERIAL COMMANDS (one per line, see CommandLine.h):
+//   S                  start scanning
+//   X                  stop scanning
+//   M                  print the memory report
+//   P                  print the profile report (ENABLE_PROFILE builds)
+//   ECHO               print the echo outcome counters per sensor
+//   RANGE min max      servo travel, degrees (within the profile)
+//   STEP deg           fine step, degrees
+//   SETTLE us          servo settle base (see Servo.h)
+//   ALERT warn danger  alert zone limits, mm
+//   GATE mm            range gate, 0 = full range
+//   FORMAT CSV|BIN     output format
+//   SECTOR first last  add a priority sector, servo degrees
+//   SECTOR AUTO        add the automatic sector (see Scanner.h)
+//   SECTOR CLEAR       remove all sectors
+//   DEFAULTS           back to the compiled-in values
+//   SAVE               keep the current values in EEPROM
+//   CONFIG             print them as CONFIG,<key>,<values> lines
+// Setting changes apply at once, mid-sweep, and answer OK;
+// anything unknown, malformed or out of range answers ERROR and
+// changes nothing. A line cut short by waking from sleep (see
+// Power.h) usually ends up as an ERROR.
+static void commandTask() {
+    settingsService();          // Background EEPROM write, a byte at a time
+    if (!commandLine.poll()) {
+        return;
+    }
+
+    uint8_t args = commandLine.count() - 1;
+    if (commandLine.is(0, PSTR("S")) && args == 0) {
+        if (!scanner.isScanning()) {
+            startScan();
+        }
+    } else if (commandLine.is(0, PSTR("X")) && args == 0) {
+        if (scanner.isScanning()) {
+            stopScan();
+        }
+    } else if (commandLine.is(0, PSTR("M")) && args == 0) {
+        memoryReport();
+#if ENABLE_PROFILE
+    } else if (commandLine.is(0, PSTR("P")) && args == 0) {
+        profileReport();
+#endif
+    } else if (commandLine.is(0, PSTR("ECHO")) && args == 0) {
+        echoReport();
+    } else if (commandLine.is(0, PSTR("CONFIG")) && args == 0) {
+        reportSettings();
+    } else if (commandLine.is(0, PSTR("SAVE")) && args == 0) {
+        settingsSave(&settings);
+        serialPort.println(F("OK"));
+    } else if (editSettings()) {
+        serialPort.println(F("OK"));
+    } else {
+        serialPort.println(F("ERROR"));
+    }
+}
+
+// READ ENVIRONMENT:
+// Get temperature and humidity for speed of sound calculation.
+// This is non-blocking - returns cached value if called too soon.
+//
+// CALCULATE DISTANCE SCALE:
+// Only when there is a new reading. The Q16 ticks-to-mm factor
+// comes straight from the sensor's integer fields, so neither
+// this nor any sample needs float math (see SpeedOfSound.h);
+// the scanner passes it on only when it actually changed.
+// Falls back to standard conditions (343 m/s at 20°C, 50%
+// humidity) while no valid reading is available: before the
+// first one, and once failed reads have made the last one stale
+// (see FAILED READS in DHTSensor.h). A single failed read keeps
+// the scale and the environment as they were.
+static void environmentTask() {
+    THReading envData;
+    PROFILE_START(t);
+    bool fresh = dht.read(&envData);
+    PROFILE_STOP(PROFILE_DHT, t);
+
+    if (fresh) {
+        scanner.setEnvironment(&envData, distanceScaleFor(envData.temperatureC10, envData.humidityRH));
+        if (scanner.isScanning()) {
+            scanner.printEnvironment(&envData);     // Binary: once per new reading
+        }
+    } else if (!envData.valid) {
+        scanner.setEnvironment(&envData, DEFAULT_DISTANCE_SCALE);
+    }
+}
+
+
+// PERFORM SCAN:
+// Advance the bidirectional sweep (10→170→10) by one state.
+static void scanTask() {
+    scanner.tick();
+}
+
+#if ENABLE_IDLE_SLEEP
+// IDLE PHASES (see Power.h):
+//   SCANNING   nothing to do
+//   PARKING    servo on its way to SERVO_MIN_ANGLE
+//   DETACHING  waiting for the last pulse to end
+//   PARKED     sleep once IDLE_WAKE_WINDOW has passed since the
+//              last wake and no DHT transaction or EEPROM save
+//              is in flight
+enum IdlePhase : uint8_t {
+    IDLE_SCANNING,
+    IDLE_PARKING,
+    IDLE_DETACHING,
+    IDLE_PARKED
+};
+
+static IdlePhase idlePhase = IDLE_SCANNING;     // Servo starts attached
+static unsigned long idleDeadline;              // micros(): servo parked
+static unsigned long awakeSince;                // millis() of the last wake
+
+static void idleTask() {
+    if (scanner.isScanning()) {
+        idlePhase = IDLE_SCANNING;
+        return;
+    }
+
+    switch (idlePhase) {
+        case IDLE_SCANNING:
+            idleDeadline = servo.moveTo(SERVO_MIN_ANGLE);
+            idlePhase = IDLE_PARKING;
+            break;
+
+        case IDLE_PARKING:
+            if ((long)(micros() - idleDeadline) >= 0) {
+                servo.detach();
+                idlePhase = IDLE_DETACHING;
+            }
+            break;
+
+        case IDLE_DETACHING:
+            if (!servo.isAttached()) {
+                awakeSince = millis();
+                idlePhase = IDLE_PARKED;
+            }
+            break;
+
+        case IDLE_PARKED:
+            if (millis() - awakeSince < IDLE_WAKE_WINDOW || dht.isBusy() || settingsSaving()) {
+                break;
+            }
+            powerSleep();
+            awakeSince = millis();
+            break;
+    }
+}
+#endif
 
 // ===========================================
 // SETUP
@@ -60,75 +453,59 @@ int main() {
     init();
 
     // Initialize serial communication
-    // 115200 baud for fast data transmission during sweep
-    Serial.begin(SERIAL_BAUD);
-    Serial.println(F("=== S I R E N ==="));
-    Serial.println(F("Sonic Imaging for Range Exploration and Navigation"));
+    // 115200 baud for fast data transmission during sweep.
+    // Our own interrupt-driven port replaces Serial (see SerialPort.h)
+    serialPort.begin(SERIAL_BAUD);
+    serialPort.println(F("=== S I R E N ==="));
+    serialPort.println(F("Sonic Imaging for Range Exploration and Navigation"));
     
     // Initialize all components
-    // Order matters: DHT needs 1 second startup delay
+    // DHT defers its first reading until it has powered up
     dht.init();
-    ultrasonic.init();
+    for (uint8_t n = 0; n < SENSOR_COUNT; n++) {
+        ultrasonic[n].init(n);
+        scanner.setSensor(n, &ultrasonic[n]);
+    }
     servo.init();
     alert.init();
     button.init();
+
+    // SETTINGS:
+    // Saved values if the EEPROM holds a valid record for this
+    // build, the compiled-in defaults otherwise
+    if (settingsLoad(&settings)) {
+        serialPort.println(F("Settings loaded from EEPROM"));
+    } else {
+        serialPort.println(F("Settings: defaults"));
+    }
+    applySettings();
+
+    scheduler.addTask(buttonTask, 0);
+    scheduler.addTask(scanTask, 0);
+    scheduler.addTask(environmentTask, ENVIRONMENT_TASK_INTERVAL);
+    scheduler.addTask(commandTask, 0);
+#if ENABLE_IDLE_SLEEP
+    scheduler.addTask(idleTask, 0);
+#endif
     
-    Serial.println(F("Press button to start/stop"));
+    // STACK HEADROOM:
+    // Everything static is allocated by now; what is left is the
+    // stack's (see Memory.h)
+    uint16_t free = memoryFree();
+    serialPort.print(F("SRAM free: "));
+    serialPort.println(free);
+    if (free < MEMORY_LOW_WATER) {
+        serialPort.println(F("WARNING: SRAM low, stack may collide"));
+    }
+
+    serialPort.println(F("Press button (or send S/X) to start/stop"));
 
     // ===========================================
     // MAIN LOOP
     // ===========================================
+    // All timing lives in the task deadlines - no delay() here.
 
     while (true) {
-        // STATE TOGGLE:
-        // Check for button press and toggle scanning state
-        if (button.isPressed()) {
-            scanning = !scanning;
-            Serial.println(scanning ? F("SCAN STARTED") : F("SCAN STOPPED"));
-            
-            // Ensure alert is off when stopping
-            if (scanning) {
-                // Print CSV header when starting
-                Serial.println(F("angle,distance,humidity,temperatureC,temperatureF"));
-            } else {
-                // Stop alert when stopping
-                alert.stop();
-            }
-        }
-        
-        // IDLE STATE:
-        // If not scanning, exit loop early (saves power, reduces noise)
-        if (!scanning) {
-            continue;
-        }
-        
-        // ===========================================
-        // ACTIVE SCANNING
-        // ===========================================
-        
-        // READ ENVIRONMENT:
-        // Get temperature and humidity for speed of sound calculation.
-        // This is non-blocking - returns cached value if called too soon.
-        THReading envData;
-        dht.read(&envData);
-        
-        // CALCULATE SPEED OF SOUND:
-        // Use environmental data if valid, otherwise fall back to
-        // standard value (343 m/s at 20°C, 50% humidity).
-        // See SpeedOfSound.h for the physics explanation.
-        float soundSpeed;
-        if (envData.valid) {
-            soundSpeed = calculateSpeedOfSound(envData.temperatureC, envData.humidity);
-        } else {
-            soundSpeed = 343.0;     // Fallback: standard conditions
-        }
-        
-        // PERFORM SCAN:
-        // Execute one complete bidirectional sweep (10→170→10).
-        // Returns false if interrupted by button press.
-        if (!scanner.scan(&envData, soundSpeed)) {
-            scanning = false;
-            Serial.println(F("SCAN STOPPED"));
-        }
+        scheduler.run();
     }
 }
@@ -0,0 +1,88 @@
+// Arduino.cpp (host)
+// Simulated clock and Print formatting
+
+#include <Arduino.h>
+#include <stdio.h>
+#include "Timer1.h"
+
+static unsigned long clockMicros = 0;
+
+unsigned long micros() {
+    return clockMicros;
+}
+
+unsigned long millis() {
+    return clockMicros / 1000;
+}
+
+// Timer1.h's extended timebase: the same simulated clock, wrapping
+// at 32 bits like the firmware's
+uint32_t timer1Micros() {
+    return (uint32_t)clockMicros;
+}
+
+void hostClockAdvance(unsigned long us) {
+    clockMicros += us;
+}
+
+void hostClockReset() {
+    clockMicros = 0;
+}
+
+// PRINT:
+// Same output as the AVR core for the types the firmware prints,
+// including fixed-digit floats ("21.50" for print(21.5)).
+size_t Print::write(const uint8_t* data, size_t length) {
+    size_t n = 0;
+    while (length--) {
+        n += write(*data++);
+    }
+    return n;
+}
+
+size_t Print::printNumber(unsigned long n, int base) {
+    char buffer[8 * sizeof(long) + 1];
+    char* p = &buffer[sizeof(buffer) - 1];
+    *p = '\0';
+    if (base < 2) {
+        base = 10;
+    }
+    do {
+        unsigned long digit = n % base;
+        *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+        n /= base;
+    } while (n);
+    return write(p);
+}
+
+size_t Print::print(const __FlashStringHelper* s) { return write(reinterpret_cast<const char*>(s)); }
+size_t Print::print(const char* s)                { return write(s); }
+size_t Print::print(char c)                       { return write((uint8_t)c); }
+size_t Print::print(unsigned char n, int base)    { return printNumber(n, base); }
+size_t Print::print(int n, int base)              { return print((long)n, base); }
+size_t Print::print(unsigned int n, int base)     { return printNumber(n, base); }
+size_t Print::print(unsigned long n, int base)    { return printNumber(n, base); }
+
+size_t Print::print(long n, int base) {
+    if (base == 10 && n < 0) {
+        return write('-') + printNumber(-(unsigned long)n, 10);
+    }
+    return printNumber((unsigned long)n, base);
+}
+
+size_t Print::print(double n, int digits) {
+    char buffer[32];
+    int length = snprintf(buffer, sizeof(buffer), "%.*f", digits, n);
+    return write((const uint8_t*)buffer, length > 0 ? length : 0);
+}
+
+size_t Print::println()                               { return write("\r\n"); }
+size_t Print::println(const __FlashStringHelper* s)   { return print(s) + println(); }
+size_t Print::println(const char* s)                  { return print(s) + println(); }
+size_t Print::println(char c)                         { return print(c) + println(); }
+size_t Print::println(unsigned char n, int base)      { return print(n, base) + println(); }
+size_t Print::println(int n, int base)                { return print(n, base) + println(); }
+size_t Print::println(unsigned int n, int base)       { return print(n, base) + println(); }
+size_t Print::println(long n, int base)               { return print(n, base) + println(); }
+size_t Print::println(unsigned long n, int base)      { return print(n, base) + println(); }
+size_t Print::println(double n, int digits)           { return print(n, digits) + println(); }
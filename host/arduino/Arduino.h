@@ -0,0 +1,85 @@
+// Arduino.h (host)
+// Minimal Arduino core for compiling firmware modules natively
+//
+// PURPOSE:
+// Lets the hardware-independent parts of the firmware (Scanner,
+// Protocol, SpeedOfSound, Profile) build unchanged on a PC.
+// Only what those modules use is provided - anything that touches
+// AVR registers stays in the firmware and is replaced by the
+// simulated components in host/sim/.
+//
+// TIME:
+// millis() and micros() read a simulated clock that only moves
+// when hostClockAdvance() is called, so runs are deterministic
+// and far faster than real time. unsigned long is 64 bits here,
+// so the clock never wraps during a run.
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+
+#define DEC 10
+#define HEX 16
+
+// Flash strings are ordinary strings on the host
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p)  (*(const uint8_t*)(p))
+#define pgm_read_word(p)  (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+
+// Same (macro) semantics as the AVR core
+#ifndef abs
+#define abs(x) ((x) > 0 ? (x) : -(x))
+#endif
+#define constrain(x, lo, hi) ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+
+// Simulated clock
+unsigned long millis();
+unsigned long micros();
+void hostClockAdvance(unsigned long us);
+void hostClockReset();
+
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t byte) = 0;
+    virtual size_t write(const uint8_t* data, size_t length);
+    size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+    size_t print(const __FlashStringHelper* s);
+    size_t print(const char* s);
+    size_t print(char c);
+    size_t print(unsigned char n, int base = DEC);
+    size_t print(int n, int base = DEC);
+    size_t print(unsigned int n, int base = DEC);
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(double n, int digits = 2);
+
+    size_t println();
+    size_t println(const __FlashStringHelper* s);
+    size_t println(const char* s);
+    size_t println(char c);
+    size_t println(unsigned char n, int base = DEC);
+    size_t println(int n, int base = DEC);
+    size_t println(unsigned int n, int base = DEC);
+    size_t println(long n, int base = DEC);
+    size_t println(unsigned long n, int base = DEC);
+    size_t println(double n, int digits = 2);
+
+private:
+    size_t printNumber(unsigned long n, int base);
+};
+
+#endif
@@ -0,0 +1,345 @@
+// main.cpp
+// siren-bench: run the firmware's Scanner against simulated hardware
+//
+// PURPOSE:
+// Measures how the scan logic performs - sweep time, samples per
+// sweep, accuracy, serial load - without a board, and fast enough
+// for CI (thousands of simulated sweeps per second).
+//
+// USAGE:
+//   siren-bench [options]
+//     --sweeps N          Sweeps to run (default 100)
+//     --room FILE         Room geometry (see sim/Room.h), default built in
+//     --binary            Binary frames instead of CSV
+//     --out FILE          Write the serial output to FILE
+//     --seed N            Noise/dropout seed (default 1)
+//     --noise MM          Echo noise, standard deviation (default 3)
+//     --dropout P         Missed-echo probability (default 0.02)
+//     --stuck P           Probability a miss latches ECHO high (default 0)
+//     --servo-speed US    Servo μs per degree (default 2000)
+//     --gate MM           Range gate (default RANGE_GATE from config.h)
+//     --capture           Add RAW frames (implies --binary), for siren-replay
+//     --output-cost US    CPU μs per serial byte queued (default 0, see SimSerial.h)
+//     --range MIN,MAX     Servo travel in degrees, as the RANGE command (default: profile)
+//     --step DEG          Fine step, as the STEP command (default: profile)
+//     --sector MIN,MAX    Priority sector, as the SECTOR command (repeatable)
+//     --sector auto       Automatic sector at the nearest echo
+//     --watch MIN,MAX     Report how often the servo revisits these angles
+//
+// SIMULATED TIME:
+// Each pass through the loop costs LOOP_MICROS, roughly one pass
+// of the firmware's scheduler. When a tick changes nothing the
+// clock jumps to the next component event (settle deadline, echo)
+// instead of spinning through the wait.
+
+#include <Arduino.h>
+#include <chrono>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Protocol.h"
+#include "Room.h"
+#include "Scanner.h"
+#include "SimComponents.h"
+#include "SimSerial.h"
+
+#define LOOP_MICROS     50
+#define IDLE_STEP_MAX   1000        // μs - waits on millis() have no event
+
+struct Options {
+    unsigned long sweeps;
+    const char* room;
+    bool binary;
+    const char* out;
+    unsigned long seed;
+    double noise;
+    double dropout;
+    double stuck;
+    double servoSpeed;
+    unsigned long gate;
+    bool capture;
+    unsigned long outputCost;
+    int rangeMin;
+    int rangeMax;
+    int step;
+    int sectors;
+    int sectorFirst[PRIORITY_SECTORS];
+    int sectorLast[PRIORITY_SECTORS];
+    bool sectorAuto;
+    int watchFirst;             // -1 = no revisit report
+    int watchLast;
+};
+
+static void usage() {
+    fprintf(stderr,
+            "usage: siren-bench [--sweeps N] [--room FILE] [--binary] [--out FILE]\n"
+            "                   [--seed N] [--noise MM] [--dropout P] [--stuck P]\n"
+            "                   [--servo-speed US]\n"
+            "                   [--gate MM] [--capture] [--output-cost US]\n"
+            "                   [--range MIN,MAX] [--step DEG] [--sector MIN,MAX|auto]\n"
+            "                   [--watch MIN,MAX]\n");
+    exit(2);
+}
+
+static Options parseOptions(int argc, char** argv) {
+    Options options = { 100, NULL, false, NULL, 1, 3.0, 0.02, 0.0, 2000.0, RANGE_GATE, false, 0,
+                        SERVO_MIN_ANGLE, SCAN_MAX_ANGLE, SERVO_STEP, 0, {}, {}, false, -1, -1 };
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--binary") == 0) {
+            options.binary = true;
+            continue;
+        }
+        if (strcmp(arg, "--capture") == 0) {
+            options.binary = true;
+            options.capture = true;
+            continue;
+        }
+        if (!value) {
+            usage();
+        }
+        if (strcmp(arg, "--sweeps") == 0) {
+            options.sweeps = strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--room") == 0) {
+            options.room = value;
+        } else if (strcmp(arg, "--out") == 0) {
+            options.out = value;
+        } else if (strcmp(arg, "--seed") == 0) {
+            options.seed = strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--noise") == 0) {
+            options.noise = atof(value);
+        } else if (strcmp(arg, "--dropout") == 0) {
+            options.dropout = atof(value);
+        } else if (strcmp(arg, "--stuck") == 0) {
+            options.stuck = atof(value);
+        } else if (strcmp(arg, "--servo-speed") == 0) {
+            options.servoSpeed = atof(value);
+        } else if (strcmp(arg, "--gate") == 0) {
+            options.gate = strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--output-cost") == 0) {
+            options.outputCost = strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--range") == 0) {
+            if (sscanf(value, "%d,%d", &options.rangeMin, &options.rangeMax) != 2) {
+                usage();
+            }
+        } else if (strcmp(arg, "--step") == 0) {
+            options.step = atoi(value);
+        } else if (strcmp(arg, "--sector") == 0 && strcmp(value, "auto") == 0) {
+            options.sectorAuto = true;
+        } else if (strcmp(arg, "--sector") == 0) {
+            if (options.sectors == PRIORITY_SECTORS) {
+                fprintf(stderr, "siren-bench: at most %d --sector\n", PRIORITY_SECTORS);
+                exit(2);
+            }
+            if (sscanf(value, "%d,%d", &options.sectorFirst[options.sectors],
+                       &options.sectorLast[options.sectors]) != 2) {
+                usage();
+            }
+            options.sectors++;
+        } else if (strcmp(arg, "--watch") == 0) {
+            if (sscanf(value, "%d,%d", &options.watchFirst, &options.watchLast) != 2) {
+                usage();
+            }
+        } else {
+            usage();
+        }
+        i++;
+    }
+
+    // sweepCount is 16 bits in the firmware
+    if (options.sweeps == 0 || options.sweeps > 0xFFFF) {
+        fprintf(stderr, "siren-bench: --sweeps must be 1-65535\n");
+        exit(2);
+    }
+    // Same limits as settingsValid() in the firmware
+    if (options.rangeMin < SERVO_MIN_ANGLE || options.rangeMax > SCAN_MAX_ANGLE ||
+        options.rangeMin >= options.rangeMax) {
+        fprintf(stderr, "siren-bench: --range must lie within %d,%d\n", SERVO_MIN_ANGLE, SCAN_MAX_ANGLE);
+        exit(2);
+    }
+    if (options.step < 1 || options.step > options.rangeMax - options.rangeMin) {
+        fprintf(stderr, "siren-bench: --step must be 1-%d\n", options.rangeMax - options.rangeMin);
+        exit(2);
+    }
+#if !ENABLE_PRIORITY_SECTORS
+    if (options.sectors > 0 || options.sectorAuto) {
+        fprintf(stderr, "siren-bench: --sector needs ENABLE_PRIORITY_SECTORS\n");
+        exit(2);
+    }
+#endif
+    for (int i = 0; i < options.sectors; i++) {
+        if (options.sectorFirst[i] < options.rangeMin || options.sectorLast[i] > options.rangeMax ||
+            options.sectorFirst[i] > options.sectorLast[i]) {
+            fprintf(stderr, "siren-bench: --sector must lie within the range\n");
+            exit(2);
+        }
+    }
+    return options;
+}
+
+// Earliest pending component event, or SIM_NO_EVENT
+static unsigned long nextEvent(SimServo* servo, std::vector<SimUltrasonic>& sensors) {
+    unsigned long next = servo->nextEvent();
+    for (size_t n = 0; n < sensors.size(); n++) {
+        unsigned long event = sensors[n].nextEvent();
+        if (event < next) {
+            next = event;
+        }
+    }
+    return next;
+}
+
+int main(int argc, char** argv) {
+    Options options = parseOptions(argc, argv);
+
+    Room room;
+    if (options.room) {
+        if (!room.load(options.room)) {
+            fprintf(stderr, "siren-bench: cannot load room '%s'\n", options.room);
+            return 1;
+        }
+    } else {
+        room.loadDefault();
+    }
+
+    FILE* out = NULL;
+    if (options.out) {
+        out = fopen(options.out, "wb");
+        if (!out) {
+            fprintf(stderr, "siren-bench: cannot open '%s'\n", options.out);
+            return 1;
+        }
+    }
+
+    ServoModel servoModel = { 3000, options.servoSpeed };
+    EchoModel echoModel = { 460, 343.0, options.noise, options.dropout, options.stuck };
+
+    simRandomSeed(options.seed);
+    hostClockReset();
+    simSerialSetSink(out);
+    simSerialSetByteCost(options.outputCost);
+    serialPort.begin(SERIAL_BAUD);
+
+    // One simulated HC-SR04 per SENSOR_COUNT, mounted like config.h says
+    SimServo servo(servoModel);
+    std::vector<SimUltrasonic> sensors;
+    for (int n = 0; n < SENSOR_COUNT; n++) {
+        sensors.emplace_back(&room, &servo, echoModel, n * SENSOR_SPACING);
+    }
+    SimAlert alert;
+    Scanner scanner(&sensors[0], &servo, &alert);
+    for (int n = 1; n < SENSOR_COUNT; n++) {
+        scanner.setSensor(n, &sensors[n]);
+    }
+
+    scanner.setOutputFormat(options.binary ? OUTPUT_BINARY : OUTPUT_CSV);
+    scanner.setRawCapture(options.capture);
+    scanner.setRangeGate(options.gate);
+    scanner.setSweep(options.rangeMin, options.rangeMax, options.step);
+#if ENABLE_PRIORITY_SECTORS
+    for (int i = 0; i < options.sectors; i++) {
+        scanner.setSector(i, options.sectorFirst[i], options.sectorLast[i]);
+    }
+    scanner.setAutoSector(options.sectorAuto);
+#endif
+
+    // REVISIT (--watch):
+    // A visit begins with the first ping inside the watched angles
+    // after one outside them; the report is the time between visits
+    unsigned long lastTriggers = 0;
+    bool inside = false;
+    unsigned long visitStart = 0;
+    unsigned long visits = 0;
+    double revisitSum = 0;
+    unsigned long revisitMax = 0;
+
+    auto wallStart = std::chrono::steady_clock::now();
+
+    scanner.start();
+    while (scanner.getSweepCount() < options.sweeps) {
+        ScanState before = scanner.getState();
+        scanner.tick();
+
+        if (options.watchFirst >= 0 && sensors[0].triggers != lastTriggers) {
+            lastTriggers = sensors[0].triggers;
+            int target = servo.target();
+            bool within = target >= options.watchFirst && target <= options.watchLast;
+            if (within && !inside) {
+                unsigned long now = micros();
+                if (visits > 0) {
+                    revisitSum += now - visitStart;
+                    revisitMax = now - visitStart > revisitMax ? now - visitStart : revisitMax;
+                }
+                visitStart = now;
+                visits++;
+            }
+            inside = within;
+        }
+
+        unsigned long step = LOOP_MICROS;
+        if (scanner.getState() == before) {
+            unsigned long now = micros();
+            unsigned long next = nextEvent(&servo, sensors);
+            if (next == SIM_NO_EVENT) {
+                step = IDLE_STEP_MAX;
+            } else if (next > now + LOOP_MICROS) {
+                step = next - now;
+            }
+        }
+        hostClockAdvance(step);
+    }
+    scanner.stop();
+    serialPort.flush();
+
+    auto wallEnd = std::chrono::steady_clock::now();
+    double wall = std::chrono::duration<double>(wallEnd - wallStart).count();
+    double simulated = micros() / 1e6;
+    double sweeps = options.sweeps;
+
+    unsigned long triggers = 0, valid = 0, timeouts = 0, beyond = 0;
+    unsigned long latchups = 0, skipped = 0;
+    double errorSum = 0;
+    for (size_t n = 0; n < sensors.size(); n++) {
+        latchups += sensors[n].latchups;
+        skipped += sensors[n].skipped;
+        triggers += sensors[n].triggers;
+        valid += sensors[n].valid;
+        timeouts += sensors[n].timeouts;
+        beyond += sensors[n].beyond;
+        errorSum += sensors[n].errorSum;
+    }
+
+    printf("sweeps            %lu (%s output, %d sensor%s)\n", options.sweeps,
+           options.binary ? "binary" : "CSV", SENSOR_COUNT, SENSOR_COUNT > 1 ? "s" : "");
+    printf("simulated time    %.2f s (%.1f ms/sweep)\n", simulated, simulated * 1000 / sweeps);
+    printf("pings             %lu (%.1f/sweep), %lu valid, %lu timeout, %lu beyond gate\n",
+           triggers, triggers / sweeps, valid, timeouts, beyond);
+    if (options.stuck > 0) {
+        printf("stuck echo        %lu latch-ups, %lu pings skipped\n", latchups, skipped);
+    }
+    printf("mean error        %.1f mm (vs. commanded angle)\n",
+           valid ? errorSum / valid : 0.0);
+    printf("serial            %lu bytes (%.0f/sweep), %u samples skipped, %lu bytes dropped, %lu stalls\n",
+           simSerialSentBytes(), simSerialSentBytes() / sweeps, scanner.getSkippedSamples(),
+           (unsigned long)serialPort.droppedBytes(), (unsigned long)serialPort.stalledBytes());
+    printf("alert             %lu updates, nearest %u mm", alert.updates, alert.nearest);
+    if (alert.soonest != 0xFFFF) {
+        printf(", soonest arrival %u ms", alert.soonest);   // ENABLE_TRACKING
+    }
+    printf("\n");
+    if (options.watchFirst >= 0) {
+        printf("revisit           %d-%d°: %lu visits, every %.0f ms (max %.0f ms)\n",
+               options.watchFirst, options.watchLast, visits,
+               visits > 1 ? revisitSum / (visits - 1) / 1000 : 0.0, revisitMax / 1000.0);
+    }
+    printf("wall time         %.3f s (%.0f sweeps/s)\n", wall, wall > 0 ? sweeps / wall : 0.0);
+
+    if (out) {
+        fclose(out);
+    }
+    return 0;
+}
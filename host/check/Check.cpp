@@ -0,0 +1,18 @@
+// Check.cpp
+// Pass/fail reporting shared by the siren-check-* programs
+
+#include "Check.h"
+#include <stdio.h>
+
+static int failures = 0;
+
+void check(bool condition, const char* what) {
+    printf("%s  %s\n", condition ? "ok  " : "FAIL", what);
+    if (!condition) {
+        failures++;
+    }
+}
+
+int checkResult() {
+    return failures == 0 ? 0 : 1;
+}
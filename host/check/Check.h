@@ -0,0 +1,14 @@
+// Check.h
+// Pass/fail reporting shared by the siren-check-* programs
+//
+// Each check prints one "ok" or "FAIL" line, and the program exits
+// non-zero if any failed, so ctest reports the failing program and
+// its output names the failing check.
+
+#ifndef CHECK_H
+#define CHECK_H
+
+void check(bool condition, const char* what);
+int checkResult();      // Exit status: 0 if every check passed
+
+#endif
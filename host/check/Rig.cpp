@@ -0,0 +1,133 @@
+// Rig.cpp
+// Scanner on simulated hardware, for the siren-check-* programs
+
+#include "Rig.h"
+#include "SimSerial.h"
+
+// As siren-bench: one main-loop pass, and the longest idle jump
+#define LOOP_MICROS   50
+#define IDLE_STEP_MAX 1000
+
+static const ServoModel SERVO_MODEL = { 3000, 2000.0 };
+
+static std::vector<SimUltrasonic> makeSensors(Room* room, SimServo* servo, const EchoModel& echo) {
+    std::vector<SimUltrasonic> sensors;
+    for (int n = 0; n < SENSOR_COUNT; n++) {
+        sensors.push_back(SimUltrasonic(room, servo, echo, n * SENSOR_SPACING));
+    }
+    return sensors;
+}
+
+Rig::Rig(const EchoModel& echo)
+    : servo(SERVO_MODEL),
+      sensors(makeSensors(&room, &servo, echo)),
+      scanner(&sensors[0], &servo, &alert) {
+    simRandomSeed(1);
+    hostClockReset();
+    capture = tmpfile();
+    simSerialSetSink(capture);
+    serialPort.begin(SERIAL_BAUD);
+    for (int n = 1; n < SENSOR_COUNT; n++) {
+        scanner.setSensor(n, &sensors[n]);
+    }
+}
+
+Rig::~Rig() {
+    simSerialSetSink(NULL);
+    if (capture) {
+        fclose(capture);
+    }
+}
+
+EchoModel Rig::quietEcho() {
+    EchoModel echo = { 460, 343.0, 0, 0, 0 };
+    return echo;
+}
+
+// One pass of the main loop, then a jump to the next event if the
+// scanner is only waiting (see siren-bench)
+void Rig::tick() {
+    ScanState before = scanner.getState();
+    scanner.tick();
+
+    unsigned long step = LOOP_MICROS;
+    if (scanner.getState() == before) {
+        unsigned long now = micros();
+        unsigned long next = servo.nextEvent();
+        for (size_t n = 0; n < sensors.size(); n++) {
+            if (sensors[n].nextEvent() < next) {
+                next = sensors[n].nextEvent();
+            }
+        }
+        if (next == SIM_NO_EVENT) {
+            step = IDLE_STEP_MAX;
+        } else if (next > now + LOOP_MICROS) {
+            step = next - now;
+        }
+    }
+    hostClockAdvance(step);
+}
+
+void Rig::runSweeps(uint16_t sweeps) {
+    while (scanner.getSweepCount() < sweeps) {
+        tick();
+    }
+}
+
+void Rig::runFor(unsigned long us) {
+    unsigned long start = micros();
+    while (micros() - start < us) {
+        tick();
+    }
+}
+
+std::vector<uint8_t> Rig::takeOutput() {
+    serialPort.flush();
+    std::vector<uint8_t> output;
+    if (capture) {
+        fflush(capture);
+        rewind(capture);
+        int c;
+        while ((c = fgetc(capture)) != EOF) {
+            output.push_back(c);
+        }
+        fclose(capture);
+    }
+    capture = tmpfile();
+    simSerialSetSink(capture);
+    return output;
+}
+
+ParserStats Rig::takeRecords(Collect* sink) {
+    std::vector<uint8_t> output = takeOutput();
+    StreamParser parser(sink);
+    parser.push(output.data(), output.size());
+    return parser.stats();
+}
+
+void Collect::onRecord(const Record& record) {
+    records.push_back(record);
+}
+
+int Collect::count(RecordType type) const {
+    int n = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        n += records[i].type == type;
+    }
+    return n;
+}
+
+ScriptedSensor::ScriptedSensor(SimServo* sensorServo, PingScript pingScript)
+    : triggers(0), servo(sensorServo), script(pingScript), angle(-1), ping(0) {
+}
+
+void ScriptedSensor::startMeasurement() {
+    int target = servo->target();
+    ping = target == angle ? ping + 1 : 0;
+    angle = target;
+    triggers++;
+}
+
+uint16_t ScriptedSensor::resultMm(uint16_t) {
+    return script(angle, ping);
+}
@@ -0,0 +1,90 @@
+// Rig.h
+// Scanner on simulated hardware, for the siren-check-* programs
+//
+// PURPOSE:
+// The wiring siren-bench does: a room, a servo and one simulated
+// HC-SR04 per SENSOR_COUNT, the firmware's Scanner on top, and the
+// serial output captured for the check to read back. The room
+// starts empty (add shapes or loadDefault()), the scanner stopped
+// (call scanner.start()). Noise and dropouts are off unless a check
+// sets them, so results repeat exactly.
+//
+// One Rig at a time: the clock and the serial port are global, and
+// the constructor resets both.
+
+#ifndef RIG_H
+#define RIG_H
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <vector>
+#include "Room.h"
+#include "Scanner.h"
+#include "SimComponents.h"
+#include "StreamParser.h"
+
+// Records as the parser completes them, in order
+class Collect : public RecordSink {
+public:
+    void onRecord(const Record& record) override;
+    int count(RecordType type) const;
+
+    std::vector<Record> records;
+};
+
+// SCRIPTED SENSOR:
+// Answers at once with script(angle, ping): the servo's commanded
+// angle and the ping's index at that angle (0 for the first). For
+// checks that need exact readings rather than a room.
+typedef uint16_t (*PingScript)(int angle, uint8_t ping);
+
+class ScriptedSensor : public RangeSensor {
+public:
+    ScriptedSensor(SimServo* servo, PingScript script);
+
+    void startMeasurement() override;
+    bool isReady() override { return true; }
+    void cancel() override {}
+    uint16_t resultMm(uint16_t scale) override;
+    uint16_t resultTicks() override { return 0; }
+    void setRangeGate(uint16_t, uint16_t) override {}
+
+    unsigned long triggers;
+
+private:
+    SimServo* servo;
+    PingScript script;
+    int angle;                  // Of the last trigger
+    uint8_t ping;
+};
+
+class Rig {
+public:
+    explicit Rig(const EchoModel& echo = quietEcho());
+    ~Rig();
+
+    static EchoModel quietEcho();
+
+    // Advances simulated time, ticking the scanner like the main loop
+    void runSweeps(uint16_t sweeps);    // Until getSweepCount() reaches it
+    void runFor(unsigned long us);
+
+    // Serial output since construction (or the last call)
+    std::vector<uint8_t> takeOutput();
+    ParserStats takeRecords(Collect* sink);     // The same, through StreamParser
+
+    Room room;
+    SimServo servo;
+    std::vector<SimUltrasonic> sensors;
+    SimAlert alert;
+    Scanner scanner;
+
+private:
+    FILE* capture;
+
+    void tick();
+    Rig(const Rig&);
+    Rig& operator=(const Rig&);
+};
+
+#endif
@@ -0,0 +1,46 @@
+// alert.cpp
+// siren-check-alert: zone changes never leave a stale alert sounding
+//
+// The firmware's Alert runs against stand-in registers (see
+// shim/Arduino.h). "Sounding" is the LED bit in PORTB or the
+// buzzer connected to OC2B (COM2B0 in TCCR2A). Exits non-zero
+// on the first failed check.
+
+#include <Arduino.h>
+#include "Alert.h"
+#include "Check.h"
+#include "SerialPort.h"
+#include "Ultrasonic.h"
+
+#define LED_BIT 5
+
+static bool sounding() {
+    return (PORTB & (1 << LED_BIT)) || (TCCR2A & (1 << COM2B0));
+}
+
+int main() {
+    serialPort.begin(SERIAL_BAUD);
+    Alert alert;
+    alert.init();
+
+    alert.updateMm(50);
+    check(sounding(), "danger reading sounds");
+    alert.setThresholds(1500, 200);
+    alert.updateMm(DISTANCE_MM_INVALID);
+    check(!sounding(), "invalid reading after setThresholds() silences");
+
+    alert.updateMm(DISTANCE_MM_INVALID);
+    alert.updateMm(50);
+    alert.stop();
+    alert.updateMm(DISTANCE_MM_INVALID);
+    check(!sounding(), "invalid reading after stop() stays silent");
+    alert.updateMm(50);
+    check(sounding(), "danger reading after stop() sounds again");
+
+    alert.updateMm(150);
+    alert.setThresholds(1000, 100);
+    alert.updateMm(150);
+    check(TIMSK2 & (1 << OCIE2A), "same reading re-judged against new zones (danger → warning)");
+
+    return checkResult();
+}
@@ -0,0 +1,129 @@
+// parser.cpp
+// siren-check-parser: StreamParser against known streams
+//
+// Hand-written streams pin down single rules; Rig runs check the
+// parser against what the firmware really prints. Exits non-zero if
+// any check fails.
+
+#include <string.h>
+#include <vector>
+#include "Check.h"
+#include "Protocol.h"
+#include "Rig.h"
+
+static void parse(Collect* sink, const char* text) {
+    StreamParser parser(sink);
+    parser.push((const uint8_t*)text, strlen(text));
+}
+
+#if ENABLE_ADAPTIVE_SWEEP
+// Direction changes between consecutive samples of one sweep
+static int backtracks(const Collect& sink) {
+    int changes = 0;
+    int last = -1, direction = 0;
+    for (size_t i = 0; i < sink.records.size(); i++) {
+        const Record& record = sink.records[i];
+        if (record.type == RECORD_SWEEP) {
+            last = -1;
+            direction = 0;
+        } else if (record.type == RECORD_SAMPLE) {
+            if (last >= 0 && record.angle != last) {
+                int step = record.angle > last ? 1 : -1;
+                changes += direction != 0 && step != direction;
+                direction = step;
+            }
+            last = record.angle;
+        }
+    }
+    return changes;
+}
+#endif
+
+static void csvSweeps() {
+    // An adaptive backtrack (108 → 105) and a sector jump (→ 60)
+    // inside sweep 0, then sweep 1 going back
+    Collect marked;
+    parse(&marked,
+          "SCAN STARTED\n"
+          "SWEEP,0,F\n"
+          "100,50.0,,,\n105,50.0,,,\n108,45.0,,,\n105,44.0,,,\n104,44.0,,,\n"
+          "60,80.0,,,\n61,80.0,,,\n109,45.0,,,\n170,-1,,,\n"
+          "SWEEP,1,R\n"
+          "170,-1,,,\n165,-1,,,\n");
+    check(marked.count(RECORD_SWEEP) == 2, "CSV: one sweep per SWEEP line, backtracks inside it");
+    check(marked.count(RECORD_SAMPLE) == 11, "CSV: every sample line decoded");
+    check(marked.records[0].type == RECORD_SWEEP && marked.records[0].sweep == 0 &&
+          marked.records[0].flags == 0 && marked.records[10].type == RECORD_SWEEP &&
+          marked.records[10].sweep == 1 && marked.records[10].flags == SWEEP_REVERSE,
+          "CSV: SWEEP line carries count and direction");
+
+    Collect legacy;
+    parse(&legacy, "10,50.0,,,\n11,50.0,,,\n12,50.0,,,\n12,50.0,,,\n11,50.0,,,\n10,50.0,,,\n");
+    check(legacy.count(RECORD_SWEEP) == 2, "CSV without markers: sweeps inferred at reversals");
+
+    // The firmware's own output, with the adaptive sweep and the
+    // sectors as config.h sets them. Open space around one moving
+    // post: coarse steps run into it and step back, and the delta
+    // filter lets it through on every sweep.
+    Rig rig;
+    rig.room.addPost(-1200, 1500, 150, 200, 0);
+    rig.scanner.setOutputFormat(OUTPUT_CSV);
+#if ENABLE_PRIORITY_SECTORS
+    rig.scanner.setAutoSector(true);
+#endif
+    rig.scanner.start();
+    rig.runSweeps(6);
+
+    Collect sim;
+    ParserStats stats = rig.takeRecords(&sim);
+    check(sim.count(RECORD_SWEEP) == rig.scanner.getSweepCount() + 1,
+          "CSV from the scanner: one sweep per sweep begun");
+#if ENABLE_ADAPTIVE_SWEEP
+    check(backtracks(sim) > 0, "CSV from the scanner: angles backtrack inside a sweep");
+#endif
+    check(stats.textLines == 0, "CSV from the scanner: no line skipped as text");
+}
+
+// Real frames from the firmware's writer, then damaged: noise
+// ahead of the first (one byte a SYNC), one with a bad CRC, and
+// one missing altogether
+static void binaryFrames() {
+    Rig rig;
+    for (int n = 0; n < 5; n++) {
+        writeSampleFrame(80 + n, 1000 + n, 0x32);
+    }
+    std::vector<uint8_t> clean = rig.takeOutput();
+    size_t size = clean.size() / 5;
+
+    std::vector<uint8_t> stream;
+    const uint8_t noise[] = { 0x12, FRAME_SYNC, FRAME_SYNC };
+    stream.insert(stream.end(), noise, noise + sizeof(noise));
+    for (size_t n = 0; n < 5; n++) {
+        if (n == 3) {
+            continue;
+        }
+        size_t at = stream.size();
+        stream.insert(stream.end(), clean.begin() + n * size, clean.begin() + (n + 1) * size);
+        if (n == 1) {
+            stream[at + 3] ^= 0x01;     // First payload byte
+        }
+    }
+
+    Collect sink;
+    StreamParser parser(&sink);
+    parser.push(stream.data(), stream.size());
+    const ParserStats& stats = parser.stats();
+    check(sink.count(RECORD_SAMPLE) == 3 && sink.records[0].angle == 80 &&
+          sink.records[0].distance == 1000 && sink.records[0].quality == 0x32,
+          "frames: first frame found after noise");
+    check(stats.resyncBytes == sizeof(noise) + size, "frames: noise and the bad frame counted as resync");
+    check(stats.crcErrors == 1 && sink.records[1].angle == 82,
+          "frames: bad CRC dropped, next frame still decoded");
+    check(stats.lostFrames == 2, "frames: dropped and missing frames counted from sequence gaps");
+}
+
+int main() {
+    csvSweeps();
+    binaryFrames();
+    return checkResult();
+}
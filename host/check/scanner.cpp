@@ -0,0 +1,182 @@
+// scanner.cpp
+// siren-check-scanner: multi-ping median, segment splitting and
+// range changes mid-sweep
+//
+// Built with PINGS_PER_ANGLE 3 and ENABLE_SEGMENT_OUTPUT on (see
+// host/CMakeLists.txt); config.h is otherwise as shipped. The
+// sensor is scripted, so every reading is known exactly. Exits
+// non-zero if any check fails.
+
+#include <algorithm>
+#include <vector>
+#include "Check.h"
+#include "Protocol.h"
+#include "Rig.h"
+
+#define SWEEP_FIRST 10
+#define SWEEP_LAST  170
+
+// By angle: three pings, two of which agree; two agreeing pings;
+// timeouts either side of one echo
+static uint16_t medianScript(int angle, uint8_t ping) {
+    static const uint16_t pings[3][3] = {
+        { 1000, 1200, 1010 },
+        { 500, 505, 0 },
+        { DISTANCE_MM_INVALID, 800, DISTANCE_MM_INVALID },
+    };
+    return pings[angle % 3][ping % 3];
+}
+
+static uint8_t medianPings(int angle) {
+    return angle % 3 == 1 ? 2 : 3;
+}
+
+static void multiPing() {
+    Rig rig;
+    ScriptedSensor sensor(&rig.servo, medianScript);
+    rig.scanner.setSensor(0, &sensor);
+    rig.scanner.setOutputFormat(OUTPUT_CSV);    // Binary would send segments
+    rig.scanner.setSweep(SWEEP_FIRST, SWEEP_LAST, 1);
+    rig.scanner.start();
+    rig.runSweeps(1);
+
+    // Sweep 0 is a keyframe: every angle once, in order
+    Collect sink;
+    rig.takeRecords(&sink);
+    std::vector<Record> samples;
+    for (size_t i = 0; i < sink.records.size(); i++) {
+        if (sink.records[i].type == RECORD_SAMPLE) {
+            samples.push_back(sink.records[i]);
+        }
+    }
+    bool every = samples.size() == SWEEP_LAST - SWEEP_FIRST + 1;
+    for (size_t i = 0; every && i < samples.size(); i++) {
+        every = samples[i].angle == SWEEP_FIRST + i;
+    }
+    check(every, "multi-ping: one sample per angle");
+    if (!every) {
+        return;
+    }
+
+    bool median = true, early = true, timeout = true;
+    unsigned long pings = 0;
+    for (size_t i = 0; i < samples.size(); i++) {
+        const Record& sample = samples[i];
+        pings += medianPings(sample.angle);
+        switch (sample.angle % 3) {
+            case 0:
+                median = median && sample.distance == 1010;
+                break;
+            case 1:
+                early = early && sample.distance == 500;
+                break;
+            default:
+                timeout = timeout && sample.distance == FRAME_DISTANCE_NONE;
+                break;
+        }
+    }
+    check(median, "multi-ping: median of three, outlier ignored");
+    check(early, "multi-ping: two agreeing pings stop early, nearer one kept");
+    check(timeout, "multi-ping: mostly timeouts give a timeout");
+    check(sensor.triggers == pings, "multi-ping: no pings beyond agreement");
+}
+
+// A wall at a slant, a step to a further object, a gap, and a
+// small near object
+static uint16_t segmentScript(int angle, uint8_t) {
+    if (angle >= 40 && angle <= 60) {
+        return 1000 + (angle - 40) * 5;
+    }
+    if (angle >= 61 && angle <= 70) {
+        return 1500;
+    }
+    if (angle >= 91 && angle <= 100) {
+        return 800;
+    }
+    return DISTANCE_MM_INVALID;
+}
+
+// In the order a forward sweep sends them
+static bool segmentsAre(std::vector<Record> segments, bool reverse) {
+    if (reverse) {
+        std::reverse(segments.begin(), segments.end());
+    }
+    return segments.size() == 3 &&
+           segments[0].angle == 40 && segments[0].last == 60 &&
+           segments[0].distance == 1000 && segments[0].mean == 1050 &&
+           segments[1].angle == 61 && segments[1].last == 70 &&
+           segments[1].distance == 1500 && segments[1].mean == 1500 &&
+           segments[2].angle == 91 && segments[2].last == 100 &&
+           segments[2].distance == 800 && segments[2].mean == 800;
+}
+
+static void segments() {
+    Rig rig;
+    ScriptedSensor sensor(&rig.servo, segmentScript);
+    rig.scanner.setSensor(0, &sensor);
+    rig.scanner.setOutputFormat(OUTPUT_BINARY);
+    rig.scanner.setSweep(SWEEP_FIRST, SWEEP_LAST, 1);
+    rig.scanner.start();
+    rig.runSweeps(2);
+
+    // Segments by the sweep they were sent in
+    Collect sink;
+    rig.takeRecords(&sink);
+    std::vector<Record> sweeps[2];
+    int sweep = -1;
+    int samples = 0;
+    for (size_t i = 0; i < sink.records.size(); i++) {
+        const Record& record = sink.records[i];
+        if (record.type == RECORD_SWEEP) {
+            sweep = record.sweep;
+        } else if (record.type == RECORD_SEGMENT && sweep >= 0 && sweep < 2) {
+            sweeps[sweep].push_back(record);
+        }
+        samples += record.type == RECORD_SAMPLE;
+    }
+    check(samples == 0, "segments: no sample frames");
+    check(segmentsAre(sweeps[0], false), "segments: split at gaps and steps, slant kept whole");
+    check(segmentsAre(sweeps[1], true), "segments: same on the way back, each lowest angle first");
+}
+
+// RANGE narrowed past the servo while it sweeps towards the new
+// range: the sweep carries on into it instead of turning round
+static void rangeChange() {
+    Rig rig;
+    rig.scanner.setOutputFormat(OUTPUT_CSV);    // Binary would send segments
+    rig.scanner.setSweep(SWEEP_FIRST, SWEEP_LAST, 1);
+    rig.scanner.start();
+    do {
+        rig.runFor(1000);
+    } while (rig.servo.target() < 30);
+    std::vector<uint8_t> output = rig.takeOutput();
+    Collect before;
+    StreamParser(&before).push(output.data(), output.size());
+
+    rig.scanner.setSweep(40, 100, 1);
+    rig.runSweeps(1);
+    int turned = rig.servo.target();
+    std::vector<uint8_t> more = rig.takeOutput();
+    output.insert(output.end(), more.begin(), more.end());
+    Collect sink;
+    StreamParser(&sink).push(output.data(), output.size());
+
+    // The angle measured when the range changed goes out after it
+    bool inside = true;
+    for (size_t i = before.records.size() + 1; i < sink.records.size(); i++) {
+        const Record& record = sink.records[i];
+        inside = inside && (record.type != RECORD_SAMPLE || (record.angle >= 40 && record.angle <= 100));
+    }
+    check(sink.count(RECORD_SWEEP) == 2 && sink.records.back().type == RECORD_SWEEP &&
+          sink.records.back().flags == SWEEP_REVERSE,
+          "range change: no sweep begun until the new end");
+    check(turned == 100, "range change: sweep turns at the new maximum");
+    check(inside, "range change: samples from the new range only");
+}
+
+int main() {
+    multiPing();
+    segments();
+    rangeChange();
+    return checkResult();
+}
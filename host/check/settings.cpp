@@ -0,0 +1,125 @@
+// settings.cpp
+// siren-check-settings: validation and the EEPROM image
+//
+// The firmware's Settings against a stand-in EEPROM (see
+// shim/avr/eeprom.h). Every rejected record differs from the
+// defaults in one field only. Exits non-zero if any check fails.
+
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include "Check.h"
+#include "Scanner.h"
+#include "SerialPort.h"
+#include "Settings.h"
+#include "Ultrasonic.h"
+
+// Field by field: the padding is not part of the record
+static bool same(const Settings* a, const Settings* b) {
+    bool equal = a->sweepMin == b->sweepMin && a->sweepMax == b->sweepMax && a->step == b->step &&
+                 a->settleUs == b->settleUs && a->warnMm == b->warnMm && a->dangerMm == b->dangerMm &&
+                 a->gateMm == b->gateMm && a->format == b->format;
+#if ENABLE_PRIORITY_SECTORS
+    for (uint8_t i = 0; i < PRIORITY_SECTORS; i++) {
+        equal = equal && a->sectorFirst[i] == b->sectorFirst[i] && a->sectorLast[i] == b->sectorLast[i];
+    }
+    equal = equal && a->sectorAuto == b->sectorAuto;
+#endif
+    return equal;
+}
+
+static void saveAll(const Settings* settings) {
+    settingsSave(settings);
+    while (settingsSaving()) {
+        settingsService();
+    }
+}
+
+static void validation() {
+    Settings defaults;
+    settingsDefaults(&defaults);
+    check(settingsValid(&defaults), "defaults are valid");
+
+    Settings s = defaults;
+    s.sweepMin = SERVO_MIN_ANGLE - 1;
+    check(!settingsValid(&s), "rejects a range below SERVO_MIN_ANGLE");
+    s = defaults;
+    s.sweepMax = SCAN_MAX_ANGLE + 1;
+    check(!settingsValid(&s), "rejects a range above SCAN_MAX_ANGLE");
+    s = defaults;
+    s.sweepMin = s.sweepMax;
+    check(!settingsValid(&s), "rejects an empty range");
+    s = defaults;
+    s.step = 0;
+    check(!settingsValid(&s), "rejects step 0");
+    s = defaults;
+    s.step = s.sweepMax - s.sweepMin + 1;
+    check(!settingsValid(&s), "rejects a step wider than the range");
+    s = defaults;
+    s.dangerMm = s.warnMm;
+    check(!settingsValid(&s), "rejects a danger zone reaching the warning zone");
+    s = defaults;
+    s.gateMm = MAX_DISTANCE * 10 + 1;
+    check(!settingsValid(&s), "rejects a gate beyond MAX_DISTANCE");
+    s = defaults;
+    s.format = OUTPUT_BINARY + 1;
+    check(!settingsValid(&s), "rejects an unknown output format");
+#if ENABLE_PRIORITY_SECTORS
+    s = defaults;
+    s.sweepMin = 40;
+    s.sectorFirst[0] = 30;
+    s.sectorLast[0] = 50;
+    check(!settingsValid(&s), "rejects a sector outside the range");
+    s = defaults;
+    s.sectorAuto = 2;
+    check(!settingsValid(&s), "rejects sectorAuto other than 0 or 1");
+#endif
+}
+
+static void persistence() {
+    memset(eepromBytes, 0xFF, sizeof(eepromBytes));
+    Settings loaded;
+    check(!settingsLoad(&loaded), "blank EEPROM loads the defaults");
+
+    Settings defaults, edited;
+    settingsDefaults(&defaults);
+    edited = defaults;
+    edited.sweepMin = 40;
+    edited.step = 2;
+    edited.gateMm = 1500;
+    edited.format = OUTPUT_BINARY;
+    saveAll(&edited);
+    check(settingsLoad(&loaded) && same(&loaded, &edited), "saved record loads back");
+
+    unsigned long writes = eepromWrites;
+    saveAll(&edited);
+    check(eepromWrites == writes, "saving the same record writes nothing");
+
+    eepromBytes[4] ^= 0x01;
+    check(!settingsLoad(&loaded) && same(&loaded, &defaults), "corrupted byte fails the CRC, defaults loaded");
+    eepromBytes[4] ^= 0x01;
+
+    eepromBytes[1]++;
+    check(!settingsLoad(&loaded), "image of a different size is ignored");
+    eepromBytes[1]--;
+
+    // Power lost halfway through a save of another record
+    Settings other = edited;
+    other.sweepMin = 50;
+    other.warnMm = 1200;
+    settingsSave(&other);
+    for (size_t n = 0; n < sizeof(Settings) / 2; n++) {
+        settingsService();
+    }
+    check(!settingsLoad(&loaded) && same(&loaded, &defaults), "torn save fails the CRC");
+    while (settingsSaving()) {
+        settingsService();
+    }
+    check(settingsLoad(&loaded) && same(&loaded, &other), "finished save loads back");
+}
+
+int main() {
+    serialPort.begin(SERIAL_BAUD);     // crc8() brings Protocol's frame writers, which need it
+    validation();
+    persistence();
+    return checkResult();
+}
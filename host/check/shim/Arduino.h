@@ -0,0 +1,31 @@
+// Arduino.h (host checks)
+// Host Arduino core plus stand-in AVR registers
+//
+// PURPOSE:
+// Lets small AVR drivers (Alert) build natively so their logic can
+// be checked. The registers are plain bytes: writes are kept for
+// the check to inspect, and nothing reacts to them - no timer
+// counts and no ISR fires. Only what those drivers touch is here.
+
+#ifndef HOST_CHECK_ARDUINO_H
+#define HOST_CHECK_ARDUINO_H
+
+#include_next <Arduino.h>
+
+#define F_CPU 16000000UL
+
+#define ISR(vector) extern "C" void vector()
+
+extern volatile uint8_t DDRB, PORTB, PINB;
+extern volatile uint8_t DDRD, PORTD;
+extern volatile uint8_t TCCR2A, TCCR2B, OCR2A, OCR2B, TCNT2, TIMSK2, TIFR2;
+
+// Timer2 bits (ATmega328P datasheet)
+#define COM2B0 4
+#define WGM21  1
+#define CS21   1
+#define CS20   0
+#define OCIE2A 1
+#define OCF2A  1
+
+#endif
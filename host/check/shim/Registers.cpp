@@ -0,0 +1,13 @@
+// Registers.cpp (host checks)
+// Storage for the stand-in AVR registers and EEPROM
+
+#include <Arduino.h>
+#include <avr/eeprom.h>
+
+volatile uint8_t DDRB, PORTB, PINB;
+volatile uint8_t DDRD, PORTD;
+volatile uint8_t TCCR2A, TCCR2B, OCR2A, OCR2B, TCNT2, TIMSK2, TIFR2;
+
+// Zeroed, not erased (0xFF): checks that care fill it first
+uint8_t eepromBytes[E2END + 1];
+unsigned long eepromWrites;
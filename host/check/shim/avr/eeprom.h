@@ -0,0 +1,34 @@
+// avr/eeprom.h (host checks)
+// Stand-in EEPROM: a byte array, always ready
+//
+// eepromWrites counts bytes actually changed, as the real
+// eeprom_update_byte only writes those.
+
+#ifndef HOST_CHECK_EEPROM_H
+#define HOST_CHECK_EEPROM_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define E2END 0x3FF     // ATmega328P: 1KB
+
+extern uint8_t eepromBytes[E2END + 1];
+extern unsigned long eepromWrites;
+
+inline void eeprom_read_block(void* dst, const void* src, size_t n) {
+    memcpy(dst, &eepromBytes[(uintptr_t)src], n);
+}
+
+inline void eeprom_update_byte(uint8_t* addr, uint8_t value) {
+    uint8_t* cell = &eepromBytes[(uintptr_t)addr];
+    if (*cell != value) {
+        *cell = value;
+        eepromWrites++;
+    }
+}
+
+inline bool eeprom_is_ready() {
+    return true;
+}
+
+#endif
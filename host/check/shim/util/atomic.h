@@ -0,0 +1,10 @@
+// util/atomic.h (host checks)
+// Single-threaded: the block simply runs once
+
+#ifndef HOST_CHECK_ATOMIC_H
+#define HOST_CHECK_ATOMIC_H
+
+#define ATOMIC_BLOCK(type) for (bool atomicOnce = true; atomicOnce; atomicOnce = false)
+#define ATOMIC_RESTORESTATE 0
+
+#endif
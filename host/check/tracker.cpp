@@ -0,0 +1,72 @@
+// tracker.cpp
+// siren-check-tracker: when a track continues and when it restarts
+//
+// The firmware's Tracker fed by hand, one angle per rule so the
+// tracks don't interact. A restarted track returns the reading
+// itself with v = 0; a continued one returns the filtered range
+// (halfway to the reading, α = 0.5). Exits non-zero if any check
+// fails.
+
+#include <Arduino.h>
+#include "Check.h"
+#include "Tracker.h"
+#include "Ultrasonic.h"
+
+// Where the 16-bit stamp wraps: 2^22 ms, about 70 minutes
+#define STAMP_WRAP_MS 4194304UL
+
+static bool restarted(Tracker* tracker, uint16_t filtered, uint16_t reading) {
+    return filtered == reading && tracker->velocity() == 0;
+}
+
+int main() {
+    Tracker tracker;
+    tracker.reset();
+
+    uint16_t r = tracker.update(90, 1000, 0);
+    check(restarted(&tracker, r, 1000), "first reading starts a track");
+    r = tracker.update(90, 1100, 1024);
+    check(r == 1050 && tracker.velocity() > 0, "reading inside the gate continues it");
+
+    tracker.update(91, 1000, 0);
+    r = tracker.update(91, 1100, 256);
+    check(r == 1050 && tracker.velocity() == 0, "revisit under TRACK_MIN_DT refines range only");
+
+    tracker.update(92, 1000, 0);
+    r = tracker.update(92, 1500, 64);
+    check(restarted(&tracker, r, 1500), "residual beyond the gate restarts");
+
+    tracker.update(93, 1000, 0);
+    r = tracker.update(93, DISTANCE_MM_INVALID, 2000);
+    check(r == DISTANCE_MM_INVALID && tracker.velocity() == 0, "no echo passes unfiltered");
+    r = tracker.update(93, 1000, 4000);
+    check(restarted(&tracker, r, 1000), "no echo ended the track");
+    r = tracker.update(93, TRACK_RANGE + 500, 6000);
+    check(r == TRACK_RANGE + 500 && tracker.velocity() == 0, "reading beyond TRACK_RANGE passes unfiltered");
+
+    tracker.update(94, 1000, 0);
+    r = tracker.update(94, 1100, 19968);
+    check(r == 1050, "revisit within TRACK_MAX_AGE continues");
+    tracker.update(95, 1000, 0);
+    r = tracker.update(95, 1100, TRACK_MAX_AGE + 1024);
+    check(restarted(&tracker, r, 1100), "revisit after TRACK_MAX_AGE restarts");
+
+    // 33s is 515 stamp ticks: a one-byte stamp would read 3 (192ms)
+    tracker.update(96, 1000, 0);
+    r = tracker.update(96, 1100, 33000);
+    check(restarted(&tracker, r, 1100), "stale track does not alias to a fresh one");
+    tracker.update(97, 1000, STAMP_WRAP_MS - 512);
+    r = tracker.update(97, 1100, STAMP_WRAP_MS + 512);
+    check(r == 1050, "stamp wrap does not end a live track");
+
+    // 100mm/s approach, seen every 2s
+    unsigned long now = 0;
+    for (int n = 0; n < 8; n++) {
+        tracker.update(98, 1800 - n * 200, now);
+        now += 2000;
+    }
+    check(tracker.velocity() < -TRACK_MIN_APPROACH && tracker.arrivalMs() != ARRIVAL_NONE,
+          "steady approach gives a closing speed");
+
+    return checkResult();
+}
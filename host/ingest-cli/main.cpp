@@ -0,0 +1,192 @@
+// main.cpp
+// siren-ingest: record SIREN units' serial output to columnar files
+//
+// PURPOSE:
+// The supported consumer for the firmware's output. Reads any
+// number of ports at once, CSV or binary (see StreamParser.h),
+// and appends each unit's sweeps to its own column directory
+// (see ColumnStore.h).
+//
+// USAGE:
+//   siren-ingest [options] PORT...
+//     --out DIR           Output root (default ".", created if missing),
+//                         one directory per port, named after it
+//     --baud N            Serial speed for ttys (default 115200)
+//
+// PORT is a serial device or any readable file - a capture from
+// siren-bench --out replays at disk speed. Each port's directory is
+// its base name, so the ports' base names must differ. Runs until every port
+// has ended, or until Ctrl-C.
+//
+// THREADS:
+// One reader per port (PortReader.h) and this thread writing all
+// of them. When no records are waiting the columns are flushed,
+// so files on disk trail the link by one idle moment.
+
+#include <chrono>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ColumnStore.h"
+#include "PortReader.h"
+
+// Records taken from one port before moving to the next
+#define DRAIN_BATCH 256
+
+// Sleep when every queue is empty
+#define IDLE_SLEEP_US 1000
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void onSignal(int) {
+    interrupted = 1;
+}
+
+static void usage() {
+    fprintf(stderr, "usage: siren-ingest [--out DIR] [--baud N] PORT...\n");
+    exit(2);
+}
+
+// Directory name for a port: its base name ("/dev/ttyUSB0" →
+// "ttyUSB0")
+static std::string unitName(const char* path) {
+    const char* slash = strrchr(path, '/');
+    std::string base = slash ? slash + 1 : path;
+    return base.empty() ? "unit" : base;
+}
+
+struct Unit {
+    const char* path;
+    std::string name;
+    PortReader reader;
+    ColumnStore store;
+};
+
+int main(int argc, char** argv) {
+    const char* out = ".";
+    unsigned long baud = 115200;
+    std::vector<const char*> ports;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--out") == 0 && i + 1 < argc) {
+            out = argv[++i];
+        } else if (strcmp(arg, "--baud") == 0 && i + 1 < argc) {
+            baud = strtoul(argv[++i], NULL, 10);
+        } else if (arg[0] == '-' && arg[1] == '-') {
+            usage();
+        } else {
+            ports.push_back(arg);
+        }
+    }
+    if (ports.empty()) {
+        usage();
+    }
+
+    // UNIT NAMES:
+    // Directories are appended to across runs, so a name must always
+    // mean the same port. Numbering clashes in argument order would
+    // not, so two ports with one base name are refused, before
+    // anything is opened (link one under another name).
+    std::vector<std::string> names;
+    for (size_t i = 0; i < ports.size(); i++) {
+        names.push_back(unitName(ports[i]));
+        for (size_t j = 0; j < i; j++) {
+            if (names[j] == names[i]) {
+                fprintf(stderr, "siren-ingest: %s and %s would both record to %s/%s\n",
+                        ports[j], ports[i], out, names[i].c_str());
+                return 2;
+            }
+        }
+    }
+
+    // Units hold threads and open files - allocate once, never move
+    std::vector<Unit*> units;
+    for (size_t i = 0; i < ports.size(); i++) {
+        Unit* unit = new Unit;
+        unit->path = ports[i];
+        unit->name = names[i];
+        std::string directory = std::string(out) + "/" + unit->name;
+        if (!unit->reader.open(unit->path, baud) || !unit->store.open(directory.c_str())) {
+            return 1;
+        }
+        units.push_back(unit);
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < units.size(); i++) {
+        units[i]->reader.start();
+    }
+
+    // WRITER LOOP:
+    // Round-robin over the queues so one busy port cannot starve
+    // the rest. A reader is only retired once it has finished and
+    // its queue is empty.
+    bool stopping = false;
+    while (true) {
+        if (interrupted && !stopping) {
+            for (size_t i = 0; i < units.size(); i++) {
+                units[i]->reader.stop();
+            }
+            stopping = true;
+        }
+
+        bool any = false;
+        bool active = false;
+        for (size_t i = 0; i < units.size(); i++) {
+            Unit* unit = units[i];
+            bool finished = unit->reader.finished();    // Before draining: nothing can follow
+            IngestEntry entry;
+            int taken = 0;
+            while (taken < DRAIN_BATCH && unit->reader.pop(&entry)) {
+                unit->store.write(entry.record, entry.timeUs);
+                taken++;
+            }
+            any = any || taken > 0;
+            active = active || !finished || taken > 0;
+        }
+
+        if (!active) {
+            break;
+        }
+        if (!any) {
+            for (size_t i = 0; i < units.size(); i++) {
+                units[i]->store.flush();
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(IDLE_SLEEP_US));
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    // SUMMARY (stderr, one block per port)
+    uint64_t totalBytes = 0;
+    for (size_t i = 0; i < units.size(); i++) {
+        Unit* unit = units[i];
+        unit->reader.join();
+        unit->store.close();
+        const ParserStats& stats = unit->reader.stats();
+        totalBytes += stats.bytes;
+        fprintf(stderr, "%s (%s)\n", unit->name.c_str(), unit->path);
+        fprintf(stderr, "  input      %llu bytes, %llu frames, %llu csv lines, %llu text lines\n",
+                (unsigned long long)stats.bytes, (unsigned long long)stats.frames,
+                (unsigned long long)stats.csvLines, (unsigned long long)stats.textLines);
+        fprintf(stderr, "  errors     %llu crc, %llu resync bytes, %llu frames lost\n",
+                (unsigned long long)stats.crcErrors, (unsigned long long)stats.resyncBytes,
+                (unsigned long long)stats.lostFrames);
+        fprintf(stderr, "  written    %llu sweeps, %llu samples, %llu segments (%llu queue stalls)\n",
+                (unsigned long long)unit->store.sweeps(), (unsigned long long)unit->store.samples(),
+                (unsigned long long)unit->store.segments(),
+                (unsigned long long)unit->reader.queueStalls());
+        delete unit;
+    }
+    fprintf(stderr, "%.3f s, %.1f MB/s\n", seconds, seconds > 0 ? totalBytes / seconds / 1e6 : 0.0);
+    return 0;
+}
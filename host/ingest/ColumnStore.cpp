@@ -0,0 +1,167 @@
+// ColumnStore.cpp
+// Columnar on-disk store for decoded records
+
+#include "ColumnStore.h"
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <string>
+
+static const char* const COLUMN_NAMES[] = {
+    "sample.angle.u8",
+    "sample.distance.u16",
+    "sample.quality.u8",
+    "sample.velocity.i16",
+    "sample.time.u32",
+    "sweep.number.u16",
+    "sweep.flags.u8",
+    "sweep.sample.u64",
+    "sweep.segment.u64",
+    "sweep.time.i64",
+    "segment.first.u8",
+    "segment.last.u8",
+    "segment.nearest.u16",
+    "segment.mean.u16",
+    "environment.sample.u64",
+    "environment.humidity.u8",
+    "environment.temperature.i16",
+    "raw.angle.u8",
+    "raw.sensor.u8",
+    "raw.ticks.u16",
+    "raw.time.u32",
+    "raw.scale.u16",
+};
+
+// Per-column stdio buffer: a second of a busy link fits in one
+#define COLUMN_BUFFER 16384
+
+// Creates the directory and any missing parents, like mkdir -p
+static bool makeDirectories(const std::string& directory) {
+    for (size_t end = directory.find('/', 1); ; end = directory.find('/', end + 1)) {
+        std::string part = directory.substr(0, end);
+        if (mkdir(part.c_str(), 0777) != 0 && errno != EEXIST) {
+            fprintf(stderr, "%s: %s\n", part.c_str(), strerror(errno));
+            return false;
+        }
+        if (end == std::string::npos) {
+            return true;
+        }
+    }
+}
+
+ColumnStore::ColumnStore() : sampleRows(0), sweepRows(0), segmentRows(0), dirty(false) {
+    for (int i = 0; i < COLUMN_COUNT; i++) {
+        files[i] = NULL;
+    }
+}
+
+ColumnStore::~ColumnStore() {
+    close();
+}
+
+bool ColumnStore::open(const char* directory) {
+    static_assert(sizeof(COLUMN_NAMES) / sizeof(COLUMN_NAMES[0]) == COLUMN_COUNT,
+                  "one file name per column");
+
+    if (!makeDirectories(directory)) {
+        return false;
+    }
+    for (int i = 0; i < COLUMN_COUNT; i++) {
+        std::string path = std::string(directory) + "/" + COLUMN_NAMES[i];
+        files[i] = fopen(path.c_str(), "ab");
+        if (files[i] == NULL) {
+            fprintf(stderr, "%s: %s\n", path.c_str(), strerror(errno));
+            close();
+            return false;
+        }
+        setvbuf(files[i], NULL, _IOFBF, COLUMN_BUFFER);
+    }
+
+    // APPEND:
+    // Row counts continue from what is already there, so the
+    // index columns stay valid across runs
+    struct stat info;
+    std::string samples = std::string(directory) + "/" + COLUMN_NAMES[SAMPLE_ANGLE];
+    std::string sweeps = std::string(directory) + "/" + COLUMN_NAMES[SWEEP_FLAGS];
+    std::string segments = std::string(directory) + "/" + COLUMN_NAMES[SEGMENT_FIRST];
+    sampleRows = stat(samples.c_str(), &info) == 0 ? info.st_size : 0;
+    sweepRows = stat(sweeps.c_str(), &info) == 0 ? info.st_size : 0;
+    segmentRows = stat(segments.c_str(), &info) == 0 ? info.st_size : 0;
+    return true;
+}
+
+// Little-endian whatever the host
+void ColumnStore::put(Column column, uint64_t value, int bytes) {
+    uint8_t data[8];
+    for (int i = 0; i < bytes; i++) {
+        data[i] = value >> (8 * i);
+    }
+    fwrite(data, 1, bytes, files[column]);
+}
+
+void ColumnStore::write(const Record& record, int64_t timeUs) {
+    if (files[0] == NULL) {
+        return;
+    }
+    dirty = true;
+
+    switch (record.type) {
+        case RECORD_SAMPLE:
+            put(SAMPLE_ANGLE, record.angle, 1);
+            put(SAMPLE_DISTANCE, record.distance, 2);
+            put(SAMPLE_QUALITY, record.quality, 1);
+            put(SAMPLE_VELOCITY, (uint16_t)record.velocity, 2);
+            put(SAMPLE_TIME, record.time, 4);
+            sampleRows++;
+            break;
+        case RECORD_SWEEP:
+            put(SWEEP_NUMBER, record.sweep, 2);
+            put(SWEEP_FLAGS, record.flags, 1);
+            put(SWEEP_SAMPLE, sampleRows, 8);
+            put(SWEEP_SEGMENT, segmentRows, 8);
+            put(SWEEP_TIME, (uint64_t)timeUs, 8);
+            sweepRows++;
+            break;
+        case RECORD_SEGMENT:
+            put(SEGMENT_FIRST, record.angle, 1);
+            put(SEGMENT_LAST, record.last, 1);
+            put(SEGMENT_NEAREST, record.distance, 2);
+            put(SEGMENT_MEAN, record.mean, 2);
+            segmentRows++;
+            break;
+        case RECORD_ENVIRONMENT:
+            put(ENVIRONMENT_SAMPLE, sampleRows, 8);
+            put(ENVIRONMENT_HUMIDITY, record.humidity, 1);
+            put(ENVIRONMENT_TEMPERATURE, (uint16_t)record.temperature, 2);
+            break;
+        case RECORD_RAW:
+            put(RAW_ANGLE, record.angle, 1);
+            put(RAW_SENSOR, record.sensor, 1);
+            put(RAW_TICKS, record.ticks, 2);
+            put(RAW_TIME, record.time, 4);
+            put(RAW_SCALE, record.scale, 2);
+            break;
+    }
+}
+
+void ColumnStore::flush() {
+    if (!dirty) {
+        return;
+    }
+    for (int i = 0; i < COLUMN_COUNT; i++) {
+        if (files[i]) {
+            fflush(files[i]);
+        }
+    }
+    dirty = false;
+}
+
+void ColumnStore::close() {
+    for (int i = 0; i < COLUMN_COUNT; i++) {
+        if (files[i]) {
+            fclose(files[i]);
+            files[i] = NULL;
+        }
+    }
+    dirty = false;
+}
@@ -0,0 +1,95 @@
+// ColumnStore.h
+// Columnar on-disk store for decoded records
+//
+// PURPOSE:
+// One directory per unit, one file per field. Each file is a plain
+// little-endian array, so a column loads with a single read (numpy
+// fromfile, mmap, ...) and a query that needs distances only reads
+// distances. The type is part of the file name.
+//
+// LAYOUT:
+//   sample.angle.u8            degrees
+//   sample.distance.u16        mm, 0xFFFF none, 0xFFFE beyond gate
+//   sample.quality.u8          pings << 4 | agreeing (0 from CSV)
+//   sample.velocity.i16        mm/s, negative = approaching (ENABLE_TRACKING, else 0)
+//   sample.time.u32            firmware timer1Micros() at the trigger (ENABLE_TIMESTAMPS, else 0)
+//   sweep.number.u16           firmware sweep counter
+//   sweep.flags.u8             SWEEP_* flags (see Protocol.h)
+//   sweep.sample.u64           index of the sweep's first sample
+//   sweep.segment.u64          index of the sweep's first segment
+//   sweep.time.i64             host receive time, μs since the epoch
+//   segment.first.u8           degrees
+//   segment.last.u8            degrees
+//   segment.nearest.u16        mm
+//   segment.mean.u16           mm
+//   environment.sample.u64     first sample the reading applies to
+//   environment.humidity.u8    % RH
+//   environment.temperature.i16  tenths of °C
+//   raw.angle.u8               degrees (RAW_CAPTURE only)
+//   raw.sensor.u8
+//   raw.ticks.u16              echo width, 0.5μs ticks, FRAME_TICKS_*
+//   raw.time.u32               firmware timer1Micros() at the trigger
+//   raw.scale.u16              Q16 ticks-to-mm factor
+//
+// Sweep i spans samples sweep.sample[i] .. sweep.sample[i+1]-1 (the
+// last one runs to the end of the sample columns); segments alike.
+// Existing files are appended to, so restarts extend the record.
+
+#ifndef COLUMN_STORE_H
+#define COLUMN_STORE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "StreamParser.h"
+
+class ColumnStore {
+public:
+    ColumnStore();
+    ~ColumnStore();
+
+    bool open(const char* directory);   // Creates it and its parents; false on error
+    void write(const Record& record, int64_t timeUs);
+    void flush();                       // Make everything so far visible on disk
+    void close();
+
+    uint64_t samples() const { return sampleRows; }
+    uint64_t sweeps() const { return sweepRows; }
+    uint64_t segments() const { return segmentRows; }
+
+private:
+    enum Column {
+        SAMPLE_ANGLE,
+        SAMPLE_DISTANCE,
+        SAMPLE_QUALITY,
+        SAMPLE_VELOCITY,
+        SAMPLE_TIME,
+        SWEEP_NUMBER,
+        SWEEP_FLAGS,
+        SWEEP_SAMPLE,
+        SWEEP_SEGMENT,
+        SWEEP_TIME,
+        SEGMENT_FIRST,
+        SEGMENT_LAST,
+        SEGMENT_NEAREST,
+        SEGMENT_MEAN,
+        ENVIRONMENT_SAMPLE,
+        ENVIRONMENT_HUMIDITY,
+        ENVIRONMENT_TEMPERATURE,
+        RAW_ANGLE,
+        RAW_SENSOR,
+        RAW_TICKS,
+        RAW_TIME,
+        RAW_SCALE,
+        COLUMN_COUNT
+    };
+
+    FILE* files[COLUMN_COUNT];
+    uint64_t sampleRows;
+    uint64_t sweepRows;
+    uint64_t segmentRows;
+    bool dirty;
+
+    void put(Column column, uint64_t value, int bytes);
+};
+
+#endif
@@ -0,0 +1,146 @@
+// PortReader.cpp
+// One reader thread per serial port
+
+#include "PortReader.h"
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+// How often a waiting reader checks for stop()
+#define POLL_TIMEOUT_MS 100
+
+#define READ_CHUNK 4096
+
+static speed_t baudConstant(unsigned long baud) {
+    switch (baud) {
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        default:     return 0;
+    }
+}
+
+static int64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+PortReader::PortReader() : fd(-1), stopping(false), done(false), parser(this),
+                           readTime(0), stalls(0) {
+}
+
+PortReader::~PortReader() {
+    stop();
+    join();
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+bool PortReader::open(const char* path, unsigned long baud) {
+    fd = ::open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return false;
+    }
+    if (!isatty(fd)) {
+        return true;
+    }
+
+    // RAW MODE:
+    // No line editing, echo or CR/LF translation - binary frames
+    // must arrive byte for byte. One byte satisfies a read().
+    speed_t speed = baudConstant(baud);
+    struct termios tty;
+    if (speed == 0 || tcgetattr(fd, &tty) != 0) {
+        fprintf(stderr, "%s: cannot set %lu baud\n", path, baud);
+        return false;
+    }
+    cfmakeraw(&tty);
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cc[VMIN] = 1;
+    tty.c_cc[VTIME] = 0;
+    if (tcsetattr(fd, TCSANOW, &tty) != 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return false;
+    }
+    tcflush(fd, TCIFLUSH);          // Drop what queued up before we listened
+    return true;
+}
+
+void PortReader::start() {
+    thread = std::thread(&PortReader::run, this);
+}
+
+void PortReader::stop() {
+    stopping.store(true);
+}
+
+void PortReader::join() {
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+bool PortReader::finished() const {
+    return done.load(std::memory_order_acquire);
+}
+
+bool PortReader::pop(IngestEntry* entry) {
+    return queue.pop(entry);
+}
+
+void PortReader::run() {
+    uint8_t buffer[READ_CHUNK];
+    struct pollfd wait;
+    wait.fd = fd;
+    wait.events = POLLIN;
+
+    while (!stopping.load(std::memory_order_relaxed)) {
+        int ready = poll(&wait, 1, POLL_TIMEOUT_MS);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+
+        ssize_t count = read(fd, buffer, sizeof(buffer));
+        if (count <= 0) {
+            if (count < 0 && (errno == EINTR || errno == EAGAIN)) {
+                continue;
+            }
+            break;                  // End of file, or the port went away
+        }
+        readTime = nowMicros();
+        parser.push(buffer, count);
+    }
+    done.store(true, std::memory_order_release);
+}
+
+// Called by the parser on this thread
+void PortReader::onRecord(const Record& record) {
+    IngestEntry entry;
+    entry.record = record;
+    entry.timeUs = readTime;
+    if (queue.push(entry)) {
+        return;
+    }
+    stalls++;
+    while (!queue.push(entry)) {
+        if (stopping.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
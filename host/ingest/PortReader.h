@@ -0,0 +1,68 @@
+// PortReader.h
+// One reader thread per serial port
+//
+// PURPOSE:
+// Reads a unit's byte stream on its own thread, decodes it with a
+// StreamParser and publishes the records through a lock-free queue
+// (see SpscQueue.h). The consumer - one writer thread for all
+// ports - never blocks a reader, and a slow port never holds up
+// the others.
+//
+// SOURCES:
+// A tty is switched to raw mode at the given baud rate. Anything
+// else (a capture file, a FIFO, /dev/stdin) is read as it is and
+// finishes at end of file.
+//
+// BACKPRESSURE:
+// If the queue is full the reader waits for room rather than
+// dropping records; the kernel's tty buffer absorbs the pause.
+
+#ifndef PORT_READER_H
+#define PORT_READER_H
+
+#include <atomic>
+#include <thread>
+#include "SpscQueue.h"
+#include "StreamParser.h"
+
+// Records in flight per port. 4096 is about a minute of CSV at
+// full resolution, or a few ms of a capture file.
+#define INGEST_QUEUE_SIZE 4096
+
+struct IngestEntry {
+    Record record;
+    int64_t timeUs;         // Host clock when its bytes were read, μs since the epoch
+};
+
+class PortReader : private RecordSink {
+public:
+    PortReader();
+    ~PortReader();
+
+    bool open(const char* path, unsigned long baud);   // false on error (reported)
+    void start();
+    void stop();                    // Ask the thread to finish; returns at once
+    void join();
+    bool finished() const;          // Thread is done: EOF, error or stop()
+
+    bool pop(IngestEntry* entry);   // Consumer side
+
+    // Valid once finished()
+    const ParserStats& stats() const { return parser.stats(); }
+    uint64_t queueStalls() const { return stalls; }     // Records that waited for room
+
+private:
+    int fd;
+    std::thread thread;
+    std::atomic<bool> stopping;
+    std::atomic<bool> done;
+    StreamParser parser;
+    SpscQueue<IngestEntry, INGEST_QUEUE_SIZE> queue;
+    int64_t readTime;
+    uint64_t stalls;
+
+    void run();
+    void onRecord(const Record& record) override;
+};
+
+#endif
@@ -0,0 +1,60 @@
+// SpscQueue.h
+// Lock-free single-producer single-consumer ring buffer
+//
+// PURPOSE:
+// Hands records from a port's reader thread to the writer thread
+// without a mutex. Same layout as the firmware's serial rings
+// (see SerialPort.h): head is written only by the producer, tail
+// only by the consumer, one slot stays empty to tell full from
+// empty. Acquire/release ordering on the indices publishes the
+// slot contents with them.
+//
+// Exactly one thread may push() and exactly one may pop().
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    // Producer: false if full
+    bool push(const T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t next = (h + 1) & (N - 1);
+        if (next == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        slots[h] = item;
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: false if empty
+    bool pop(T* item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *item = slots[t];
+        tail.store((t + 1) & (N - 1), std::memory_order_release);
+        return true;
+    }
+
+private:
+    T slots[N];
+    // Padding keeps the indices on separate cache lines, so the two
+    // threads don't bounce one between them (alignas would need
+    // C++17 aligned new for heap-allocated queues)
+    std::atomic<size_t> head;
+    char padding[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> tail;
+};
+
+#endif
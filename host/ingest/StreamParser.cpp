@@ -0,0 +1,390 @@
+// StreamParser.cpp
+// Incremental decoder for the firmware's serial output
+
+#include "StreamParser.h"
+#include <stdlib.h>
+#include <string.h>
+
+// CRC-8 TABLE:
+// Same polynomial as crc8() in Protocol.cpp (0x07, init 0x00).
+// The firmware computes it bitwise to save flash; here a table
+// keeps the parser at one lookup per byte. Built once, on first
+// use (thread-safe static initialisation).
+struct CrcTable {
+    uint8_t entries[256];
+
+    CrcTable() {
+        for (int i = 0; i < 256; i++) {
+            uint8_t crc = i;
+            for (int b = 0; b < 8; b++) {
+                crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+static uint8_t crc8Table(const uint8_t* data, uint8_t length) {
+    static const CrcTable table;
+    uint8_t crc = 0x00;
+    for (uint8_t i = 0; i < length; i++) {
+        crc = table.entries[crc ^ data[i]];
+    }
+    return crc;
+}
+
+// Frame size by TYPE, 0 = not a frame
+static uint8_t frameSizeFor(uint8_t type) {
+    switch (type) {
+        case FRAME_SAMPLE:      return FRAME_SAMPLE_SIZE;
+        case FRAME_ENVIRONMENT: return FRAME_ENVIRONMENT_SIZE;
+        case FRAME_SWEEP:       return FRAME_SWEEP_SIZE;
+        case FRAME_SEGMENT:     return FRAME_SEGMENT_SIZE;
+        case FRAME_RAW:         return FRAME_RAW_SIZE;
+        case FRAME_TRACK:       return FRAME_TRACK_SIZE;
+        case FRAME_TIME:        return FRAME_TIME_SIZE;
+        default:                return 0;
+    }
+}
+
+static uint16_t le16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+StreamParser::StreamParser(RecordSink* recordSink) {
+    sink = recordSink;
+    memset(&counters, 0, sizeof(counters));
+    frameLength = 0;
+    frameSize = 0;
+    haveSequence = false;
+    sequence = 0;
+    havePendingTime = false;
+    pendingTime = 0;
+    timeSequence = 0;
+    lineLength = 0;
+    lineOverflow = false;
+    haveEnvironment = false;
+    lastTemperature = 0;
+    lastHumidity = 0;
+    lastAngle = -1;
+    direction = 0;
+    csvSweep = 0;
+    csvMarkers = false;
+}
+
+void StreamParser::push(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        push(data[i]);
+    }
+}
+
+void StreamParser::push(uint8_t byte) {
+    counters.bytes++;
+    consume(byte);
+}
+
+void StreamParser::consume(uint8_t byte) {
+    if (frameLength > 0) {
+        frameByte(byte);
+        return;
+    }
+    if (byte == FRAME_SYNC) {
+        // Text never contains SYNC: whatever was pending was noise
+        counters.resyncBytes += lineLength;
+        lineLength = 0;
+        lineOverflow = false;
+        frame[0] = byte;
+        frameLength = 1;
+        return;
+    }
+    textByte(byte);
+}
+
+// ===========================================
+// BINARY FRAMES
+// ===========================================
+
+void StreamParser::frameByte(uint8_t byte) {
+    frame[frameLength++] = byte;
+    if (frameLength == 2) {
+        frameSize = frameSizeFor(byte);
+        if (frameSize == 0) {
+            resync();
+        }
+    } else if (frameLength == frameSize) {
+        decodeFrame();
+    }
+}
+
+// Drop the SYNC that started this candidate and parse what
+// followed it again - a real SYNC may be among those bytes
+void StreamParser::resync() {
+    uint8_t pending[PARSER_FRAME_MAX];
+    uint8_t count = frameLength - 1;
+    memcpy(pending, &frame[1], count);
+    frameLength = 0;
+    counters.resyncBytes++;
+    for (uint8_t i = 0; i < count; i++) {
+        consume(pending[i]);
+    }
+}
+
+void StreamParser::decodeFrame() {
+    if (crc8Table(&frame[1], frameSize - 2) != frame[frameSize - 1]) {
+        counters.crcErrors++;
+        resync();
+        return;
+    }
+    frameLength = 0;
+    counters.frames++;
+
+    uint8_t seq = frame[2];
+    if (haveSequence) {
+        counters.lostFrames += (uint8_t)(seq - sequence);
+    }
+    haveSequence = true;
+    sequence = seq + 1;
+
+    // TIME PREFIX:
+    // A TIME frame belongs to the sample frame right after it. It is
+    // held until then and dropped if anything else - or a gap in the
+    // sequence - comes between them.
+    const uint8_t* payload = &frame[3];
+    bool timed = havePendingTime && seq == (uint8_t)(timeSequence + 1);
+    havePendingTime = false;
+    if (frame[1] == FRAME_TIME) {
+        pendingTime = le16(&payload[0]) | ((uint32_t)le16(&payload[2]) << 16);
+        timeSequence = seq;
+        havePendingTime = true;
+        return;
+    }
+
+    Record record;
+    memset(&record, 0, sizeof(record));
+    switch (frame[1]) {
+        case FRAME_SAMPLE:
+            record.type = RECORD_SAMPLE;
+            record.angle = payload[0];
+            record.distance = le16(&payload[1]);
+            record.quality = payload[3];
+            record.time = timed ? pendingTime : 0;
+            break;
+        case FRAME_TRACK:
+            record.type = RECORD_SAMPLE;
+            record.angle = payload[0];
+            record.distance = le16(&payload[1]);
+            record.quality = payload[3];
+            record.velocity = (int16_t)le16(&payload[4]);
+            record.time = timed ? pendingTime : 0;
+            break;
+        case FRAME_ENVIRONMENT:
+            record.type = RECORD_ENVIRONMENT;
+            record.humidity = payload[0];
+            record.temperature = (int16_t)le16(&payload[1]);
+            break;
+        case FRAME_SWEEP:
+            record.type = RECORD_SWEEP;
+            record.sweep = le16(&payload[0]);
+            record.flags = payload[2];
+            break;
+        case FRAME_SEGMENT:
+            record.type = RECORD_SEGMENT;
+            record.angle = payload[0];
+            record.last = payload[1];
+            record.distance = le16(&payload[2]);
+            record.mean = le16(&payload[4]);
+            break;
+        case FRAME_RAW:
+            record.type = RECORD_RAW;
+            record.angle = payload[0];
+            record.sensor = payload[1];
+            record.ticks = le16(&payload[2]);
+            record.time = le16(&payload[4]) | ((uint32_t)le16(&payload[6]) << 16);
+            record.scale = le16(&payload[8]);
+            break;
+    }
+    sink->onRecord(record);
+}
+
+// ===========================================
+// CSV LINES
+// ===========================================
+
+void StreamParser::textByte(uint8_t byte) {
+    if (byte == '\n') {
+        if (lineOverflow) {
+            counters.textLines++;
+        } else {
+            line[lineLength] = '\0';
+            decodeLine();
+        }
+        lineLength = 0;
+        lineOverflow = false;
+        return;
+    }
+    if (byte == '\r') {
+        return;
+    }
+    if (lineLength + 1 >= PARSER_LINE_MAX) {
+        lineOverflow = true;
+        return;
+    }
+    line[lineLength++] = byte;
+}
+
+// FIXED-POINT NUMBER:
+// "-12.345" with decimals = 1 → -123. Rounds on the next digit.
+// The whole field must be a number; false otherwise.
+static bool parseFixed(const char* text, int decimals, int32_t* value) {
+    bool negative = *text == '-';
+    if (negative) {
+        text++;
+    }
+    if (*text < '0' || *text > '9') {
+        return false;
+    }
+
+    int32_t result = 0;
+    while (*text >= '0' && *text <= '9') {
+        result = result * 10 + (*text++ - '0');
+    }
+    int fraction = 0;
+    if (*text == '.') {
+        text++;
+        while (*text >= '0' && *text <= '9') {
+            if (fraction < decimals) {
+                result = result * 10 + (*text - '0');
+            } else if (fraction == decimals && *text >= '5') {
+                result++;
+            }
+            fraction++;
+            text++;
+        }
+    }
+    for (; fraction < decimals; fraction++) {
+        result *= 10;
+    }
+    if (*text != '\0') {
+        return false;
+    }
+    *value = negative ? -result : result;
+    return true;
+}
+
+// LINE FORMAT (see Scanner::printData()):
+//   angle,distance,humidity,temperatureC,temperatureF[,time]
+//   SWEEP,count,F|R     (Scanner::beginSweep())
+// distance in cm with one decimal (so tenths = mm), -1 no reading,
+// -2 beyond the range gate. The environment fields are empty while
+// the DHT11 has no valid reading. time is the trigger time in μs,
+// present when the firmware was built with ENABLE_TIMESTAMPS.
+void StreamParser::decodeLine() {
+    char* fields[6];
+    uint8_t count = 0;
+    fields[count++] = line;
+    for (char* p = line; *p != '\0'; p++) {
+        if (*p == ',') {
+            if (count == 6) {
+                count++;
+                break;
+            }
+            *p = '\0';
+            fields[count++] = p + 1;
+        }
+    }
+
+    int32_t sweep;
+    if (count == 3 && strcmp(fields[0], "SWEEP") == 0 && parseFixed(fields[1], 0, &sweep) &&
+        sweep >= 0 && sweep <= 0xFFFF && (strcmp(fields[2], "F") == 0 || strcmp(fields[2], "R") == 0)) {
+        Record record;
+        memset(&record, 0, sizeof(record));
+        record.type = RECORD_SWEEP;
+        record.sweep = sweep;
+        record.flags = fields[2][0] == 'R' ? SWEEP_REVERSE : 0;
+        sink->onRecord(record);
+        csvMarkers = true;
+        counters.csvLines++;
+        return;
+    }
+
+    int32_t angle, distance;
+    if ((count != 5 && count != 6) || !parseFixed(fields[0], 0, &angle) || angle < 0 || angle > 255 ||
+        !parseFixed(fields[1], 1, &distance)) {
+        // Status text. A new scan restarts the direction tracking.
+        if (strncmp(line, "SCAN STARTED", 12) == 0) {
+            lastAngle = -1;
+        }
+        counters.textLines++;
+        return;
+    }
+
+    uint16_t distanceMm;
+    if (distance == -10) {
+        distanceMm = FRAME_DISTANCE_NONE;
+    } else if (distance == -20) {
+        distanceMm = FRAME_DISTANCE_BEYOND;
+    } else if (distance >= 0 && distance < FRAME_DISTANCE_BEYOND) {
+        distanceMm = distance;
+    } else {
+        counters.textLines++;
+        return;
+    }
+
+    int32_t humidity, temperature;
+    if (fields[2][0] != '\0' && parseFixed(fields[2], 0, &humidity) &&
+        parseFixed(fields[3], 1, &temperature) &&
+        (!haveEnvironment || humidity != lastHumidity || temperature != lastTemperature)) {
+        Record record;
+        memset(&record, 0, sizeof(record));
+        record.type = RECORD_ENVIRONMENT;
+        record.humidity = humidity;
+        record.temperature = temperature;
+        sink->onRecord(record);
+        haveEnvironment = true;
+        lastHumidity = humidity;
+        lastTemperature = temperature;
+    }
+
+    // Unsigned 32-bit; too big for parseFixed()
+    uint32_t time = 0;
+    if (count == 6) {
+        char* end;
+        unsigned long value = strtoul(fields[5], &end, 10);
+        if (fields[5][0] < '0' || fields[5][0] > '9' || *end != '\0' || value > 0xFFFFFFFFUL) {
+            counters.textLines++;
+            return;
+        }
+        time = value;
+    }
+
+    counters.csvLines++;
+    csvSample(angle, distanceMm, time);
+}
+
+// Without markers, emits a SWEEP record before the first sample of
+// each inferred sweep (see CSV SWEEPS). A scan always begins forward.
+void StreamParser::csvSample(int angle, uint16_t distance, uint32_t time) {
+    Record record;
+    memset(&record, 0, sizeof(record));
+
+    int step = 0;
+    if (lastAngle >= 0 && angle != lastAngle) {
+        step = angle > lastAngle ? 1 : -1;
+    }
+    if (!csvMarkers && (lastAngle < 0 || (step != 0 && step != direction))) {
+        direction = lastAngle < 0 ? 1 : step;
+        record.type = RECORD_SWEEP;
+        record.sweep = csvSweep++;
+        record.flags = direction < 0 ? SWEEP_REVERSE : 0;
+        sink->onRecord(record);
+    }
+    lastAngle = angle;
+
+    record.type = RECORD_SAMPLE;
+    record.sweep = 0;
+    record.flags = 0;
+    record.angle = angle;
+    record.distance = distance;
+    record.time = time;
+    sink->onRecord(record);
+}
@@ -0,0 +1,140 @@
+// StreamParser.h
+// Incremental decoder for the firmware's serial output
+//
+// PURPOSE:
+// Turns the byte stream from one SIREN unit into records, whichever
+// output format it was built with (see Protocol.h and Scanner.h):
+//   - binary frames: SYNC, TYPE, SEQ, payload, CRC8
+//     (a TRACK frame is a sample with a velocity, a TIME frame
+//     timestamps the sample after it)
+//   - CSV lines:     angle,distance,humidity,temperatureC,temperatureF
+//     and an optional sixth field, the trigger time, plus a
+//     SWEEP,<count>,<F|R> line at the start of each sweep
+// Status text (boot banner, "SCAN STARTED", the CSV header) is
+// skipped in either mode.
+//
+// NO ALLOCATION:
+// All state is a fixed line buffer and a fixed frame buffer inside
+// the object; push() never allocates, so one parser per port can
+// keep up with any number of units.
+//
+// RESYNC:
+// SYNC (0xA5) never occurs in text, so it always starts a frame
+// candidate. A candidate with an unknown type or a bad CRC is
+// dropped and the bytes after its SYNC are parsed again, so a lost
+// byte costs at most the frame it was in. Text lines longer than
+// the buffer are skipped up to the next newline.
+//
+// CSV SWEEPS:
+// Sweeps come from the firmware's SWEEP lines. The angles cannot
+// tell: adaptive steps and priority sectors step back and jump
+// inside a sweep. Only captures from firmware older than the
+// marker fall back to starting a sweep whenever the angles reverse,
+// which is merely approximate; the first marker turns that off.
+//
+// SEQUENCE GAPS:
+// Frames carry a sequence number. A jump counts the frames lost
+// between two good ones (dropped by the firmware under backpressure
+// or corrupted on the wire).
+
+#ifndef STREAM_PARSER_H
+#define STREAM_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Protocol.h"
+
+enum RecordType : uint8_t {
+    RECORD_SAMPLE,
+    RECORD_ENVIRONMENT,
+    RECORD_SWEEP,
+    RECORD_SEGMENT,
+    RECORD_RAW
+};
+
+// One decoded frame or CSV line. Fields not used by a type are 0.
+struct Record {
+    RecordType type;
+    uint8_t angle;          // SAMPLE/RAW angle, SEGMENT first angle
+    uint8_t last;           // SEGMENT last angle
+    uint8_t quality;        // SAMPLE (CSV: 0, not transmitted)
+    int16_t velocity;       // SAMPLE mm/s, from TRACK frames (otherwise 0)
+    uint8_t flags;          // SWEEP flags (SWEEP_KEYFRAME, ...)
+    uint8_t humidity;       // ENVIRONMENT % RH
+    int16_t temperature;    // ENVIRONMENT tenths of °C
+    uint16_t distance;      // SAMPLE mm / FRAME_DISTANCE_*, SEGMENT nearest mm
+    uint16_t mean;          // SEGMENT mean mm
+    uint16_t sweep;         // SWEEP counter
+    uint8_t sensor;         // RAW
+    uint16_t ticks;         // RAW echo width, FRAME_TICKS_*
+    uint16_t scale;         // RAW Q16 ticks-to-mm factor
+    uint32_t time;          // RAW/SAMPLE timer1Micros() at the trigger (0 = not sent)
+};
+
+// Receives records as they are completed
+class RecordSink {
+public:
+    virtual void onRecord(const Record& record) = 0;
+
+protected:
+    ~RecordSink() {}
+};
+
+struct ParserStats {
+    uint64_t bytes;
+    uint64_t frames;            // Good binary frames
+    uint64_t csvLines;          // CSV samples and SWEEP lines
+    uint64_t textLines;         // Status lines skipped
+    uint64_t crcErrors;
+    uint64_t resyncBytes;       // Bytes discarded while out of step
+    uint64_t lostFrames;        // From sequence number gaps
+};
+
+// Largest frame and text line accepted
+#define PARSER_FRAME_MAX 16
+#define PARSER_LINE_MAX  64
+
+class StreamParser {
+public:
+    explicit StreamParser(RecordSink* sink);
+
+    void push(uint8_t byte);
+    void push(const uint8_t* data, size_t length);
+    const ParserStats& stats() const { return counters; }
+
+private:
+    RecordSink* sink;
+    ParserStats counters;
+
+    uint8_t frame[PARSER_FRAME_MAX];
+    uint8_t frameLength;        // 0 = not in a frame
+    uint8_t frameSize;          // Expected, once TYPE is known
+    bool haveSequence;
+    uint8_t sequence;           // Next expected SEQ
+    bool havePendingTime;       // TIME frame waiting for its sample
+    uint32_t pendingTime;
+    uint8_t timeSequence;       // ...and its SEQ
+
+    char line[PARSER_LINE_MAX];
+    uint8_t lineLength;
+    bool lineOverflow;
+
+    // CSV state
+    bool haveEnvironment;
+    int16_t lastTemperature;
+    uint8_t lastHumidity;
+    int lastAngle;              // -1 = none yet
+    int direction;              // +1, -1, 0 = unknown
+    uint16_t csvSweep;          // Inferred sweeps only
+    bool csvMarkers;            // SWEEP lines seen: no inferring
+
+    void consume(uint8_t byte);  // push() without counting
+    void frameByte(uint8_t byte);
+    void resync();
+    void decodeFrame();
+    void textByte(uint8_t byte);
+    void decodeLine();
+    void csvSample(int angle, uint16_t distance, uint32_t time);
+};
+
+#endif
@@ -0,0 +1,214 @@
+// main.cpp
+// siren-replay: run the firmware's Scanner on a raw capture
+//
+// PURPOSE:
+// Reproduces field behaviour offline. A capture taken with
+// RAW_CAPTURE (see config.h) holds every echo the unit saw; this
+// feeds them back through the unchanged Scanner, its filters and
+// encoders, far faster than real time. Same capture, same build,
+// same output - so filter and segmentation changes can be compared
+// on real data from a site.
+//
+// USAGE:
+//   siren-replay [options] CAPTURE
+//     --passes N          Play the capture N times (default 1)
+//     --binary            Binary frames instead of CSV
+//     --out FILE          Write the serial output to FILE
+//     --gate MM           Range gate (default RANGE_GATE from config.h)
+//
+// SWEEP ALIGNMENT:
+// Replay starts at the first forward sweep of the capture and
+// plays an even number of sweeps, so the scanner's direction
+// matches the recording on every pass.
+
+#include <Arduino.h>
+#include <chrono>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Protocol.h"
+#include "Recording.h"
+#include "ReplayComponents.h"
+#include "Scanner.h"
+#include "SimSerial.h"
+
+#define LOOP_MICROS     50
+#define IDLE_STEP_MAX   1000        // μs - waits on millis() have no event
+
+struct Options {
+    const char* capture;
+    unsigned long passes;
+    bool binary;
+    const char* out;
+    unsigned long gate;
+};
+
+static void usage() {
+    fprintf(stderr,
+            "usage: siren-replay [--passes N] [--binary] [--out FILE] [--gate MM] CAPTURE\n");
+    exit(2);
+}
+
+static Options parseOptions(int argc, char** argv) {
+    Options options = { NULL, 1, false, NULL, RANGE_GATE };
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--binary") == 0) {
+            options.binary = true;
+            continue;
+        }
+        if (arg[0] != '-') {
+            if (options.capture) {
+                usage();
+            }
+            options.capture = arg;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage();
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--passes") == 0) {
+            options.passes = strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--out") == 0) {
+            options.out = value;
+        } else if (strcmp(arg, "--gate") == 0) {
+            options.gate = strtoul(value, NULL, 10);
+        } else {
+            usage();
+        }
+    }
+    if (!options.capture || options.passes == 0) {
+        usage();
+    }
+    return options;
+}
+
+// Environment of a recorded sweep, as DHTSensor would have cached it
+static THReading environmentOf(const RecordedSweep& sweep) {
+    THReading reading;
+    reading.valid = sweep.haveEnvironment;
+    reading.humidityRH = sweep.humidity;
+    reading.temperatureC10 = sweep.temperature;
+    reading.humidity = sweep.humidity;
+    reading.temperatureC = sweep.temperature / 10.0f;
+    reading.temperatureF = reading.temperatureC * 1.8f + 32;
+    return reading;
+}
+
+int main(int argc, char** argv) {
+    Options options = parseOptions(argc, argv);
+
+    Recording recording;
+    if (!recording.load(options.capture)) {
+        return 1;
+    }
+
+    size_t base = 0;
+    while (base < recording.sweeps() && (recording.sweep(base).flags & SWEEP_REVERSE)) {
+        base++;
+    }
+    size_t usable = (recording.sweeps() - base) & ~(size_t)1;
+    if (usable == 0) {
+        fprintf(stderr, "siren-replay: capture holds no full forward/reverse sweep pair\n");
+        return 1;
+    }
+
+    FILE* out = NULL;
+    if (options.out) {
+        out = fopen(options.out, "wb");
+        if (!out) {
+            fprintf(stderr, "siren-replay: cannot open '%s'\n", options.out);
+            return 1;
+        }
+    }
+
+    hostClockReset();
+    simSerialSetSink(out);
+    serialPort.begin(SERIAL_BAUD);
+
+    ReplayServo servo;
+    std::vector<ReplaySensor> sensors;
+    for (int n = 0; n < SENSOR_COUNT; n++) {
+        sensors.emplace_back(&recording, &servo, n);
+    }
+    SimAlert alert;
+    Scanner scanner(&sensors[0], &servo, &alert);
+    for (int n = 1; n < SENSOR_COUNT; n++) {
+        scanner.setSensor(n, &sensors[n]);
+    }
+    scanner.setOutputFormat(options.binary ? OUTPUT_BINARY : OUTPUT_CSV);
+    scanner.setRangeGate(options.gate);
+
+    unsigned long total = usable * options.passes;
+    uint16_t current = 0xFFFF;
+
+    auto wallStart = std::chrono::steady_clock::now();
+
+    scanner.start();
+    while (scanner.getSweepCount() < total) {
+        // NEXT RECORDED SWEEP:
+        // The scale travels in every RAW frame; pass it on the way
+        // environmentTask() would have.
+        if (scanner.getSweepCount() != current) {
+            current = scanner.getSweepCount();
+            size_t index = base + current % usable;
+            const RecordedSweep& sweep = recording.sweep(index);
+            THReading environment = environmentOf(sweep);
+            scanner.setEnvironment(&environment, recording.ping(sweep.first).scale);
+            for (size_t n = 0; n < sensors.size(); n++) {
+                sensors[n].setSweep(index);
+            }
+        }
+
+        ScanState before = scanner.getState();
+        scanner.tick();
+
+        unsigned long step = LOOP_MICROS;
+        if (scanner.getState() == before) {
+            unsigned long now = micros();
+            unsigned long next = SIM_NO_EVENT;
+            for (size_t n = 0; n < sensors.size(); n++) {
+                unsigned long event = sensors[n].nextEvent();
+                next = event < next ? event : next;
+            }
+            if (next == SIM_NO_EVENT) {
+                step = IDLE_STEP_MAX;
+            } else if (next > now + LOOP_MICROS) {
+                step = next - now;
+            }
+        }
+        hostClockAdvance(step);
+    }
+    scanner.stop();
+    serialPort.flush();
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double simulated = micros() / 1e6;
+
+    unsigned long pings = 0, unmatched = 0;
+    for (size_t n = 0; n < sensors.size(); n++) {
+        pings += sensors[n].pings;
+        unmatched += sensors[n].unmatched;
+    }
+    const ParserStats& stats = recording.stats();
+
+    printf("capture           %s: %zu sweeps, %llu frames, %llu crc errors, %llu lost\n",
+           options.capture, recording.sweeps(), (unsigned long long)stats.frames,
+           (unsigned long long)stats.crcErrors, (unsigned long long)stats.lostFrames);
+    printf("replayed          %lu sweeps (%zu x %lu passes, from sweep %zu)\n",
+           total, usable, options.passes, base);
+    printf("pings             %lu, %lu from a neighbouring angle\n", pings, unmatched);
+    printf("simulated time    %.2f s (%.1f ms/sweep)\n", simulated, simulated * 1000 / total);
+    printf("serial            %lu bytes (%.0f/sweep)\n",
+           simSerialSentBytes(), simSerialSentBytes() / (double)total);
+    printf("alert             %lu updates, nearest %u mm\n", alert.updates, alert.nearest);
+    printf("wall time         %.3f s (%.0f sweeps/s)\n", wall, wall > 0 ? total / wall : 0.0);
+
+    if (out) {
+        fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Recording.cpp
+// A raw capture, loaded for replay
+
+#include "Recording.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#define READ_CHUNK 65536
+
+Recording::Recording() : haveEnvironment(false), humidity(0), temperature(0) {
+    memset(&parserStats, 0, sizeof(parserStats));
+}
+
+bool Recording::load(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    StreamParser parser(this);
+    std::vector<uint8_t> buffer(READ_CHUNK);
+    size_t count;
+    while ((count = fread(buffer.data(), 1, buffer.size(), file)) > 0) {
+        parser.push(buffer.data(), count);
+    }
+    fclose(file);
+    parserStats = parser.stats();
+
+    // A trailing sweep without pings (capture ended as it began) is noise
+    while (!sweepList.empty() && sweepList.back().count == 0) {
+        sweepList.pop_back();
+    }
+    if (pingList.empty() || sweepList.empty()) {
+        fprintf(stderr, "%s: no RAW frames (capture with RAW_CAPTURE and binary output)\n", path);
+        return false;
+    }
+    return true;
+}
+
+void Recording::onRecord(const Record& record) {
+    switch (record.type) {
+        case RECORD_SWEEP: {
+            RecordedSweep sweep;
+            sweep.flags = record.flags;
+            sweep.first = pingList.size();
+            sweep.count = 0;
+            sweep.haveEnvironment = haveEnvironment;
+            sweep.humidity = humidity;
+            sweep.temperature = temperature;
+            sweepList.push_back(sweep);
+            break;
+        }
+        case RECORD_ENVIRONMENT:
+            haveEnvironment = true;
+            humidity = record.humidity;
+            temperature = record.temperature;
+            break;
+        case RECORD_RAW:
+            if (!sweepList.empty()) {
+                RawPing ping;
+                ping.angle = record.angle;
+                ping.sensor = record.sensor;
+                ping.ticks = record.ticks;
+                ping.scale = record.scale;
+                pingList.push_back(ping);
+                sweepList.back().count++;
+            }
+            break;
+        default:
+            break;
+    }
+}
@@ -0,0 +1,59 @@
+// Recording.h
+// A raw capture, loaded for replay
+//
+// PURPOSE:
+// Reads a serial capture taken with RAW_CAPTURE on (binary output)
+// - from siren-bench --capture, or a field unit's port dumped to a
+// file - and keeps what replay needs: the RAW pings of each sweep
+// and the environment at its start. Any other frames are ignored.
+//
+// Pings that arrive before the first SWEEP frame belong to no
+// sweep and are dropped.
+
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "StreamParser.h"
+
+struct RawPing {
+    uint8_t angle;          // Degrees the sensor was pointing
+    uint8_t sensor;
+    uint16_t ticks;         // FRAME_TICKS_NONE / _BEYOND or the echo width
+    uint16_t scale;         // Q16 ticks-to-mm factor in use
+};
+
+struct RecordedSweep {
+    uint8_t flags;          // SWEEP_* from the SWEEP frame
+    size_t first;           // Index of its first ping
+    size_t count;
+    bool haveEnvironment;   // Had a reading been seen by then?
+    uint8_t humidity;       // % RH
+    int16_t temperature;    // tenths of °C
+};
+
+class Recording : private RecordSink {
+public:
+    Recording();
+
+    bool load(const char* path);     // false on error (reported)
+
+    size_t sweeps() const { return sweepList.size(); }
+    const RecordedSweep& sweep(size_t index) const { return sweepList[index]; }
+    const RawPing& ping(size_t index) const { return pingList[index]; }
+    const ParserStats& stats() const { return parserStats; }
+
+private:
+    std::vector<RawPing> pingList;
+    std::vector<RecordedSweep> sweepList;
+    ParserStats parserStats;
+    bool haveEnvironment;
+    uint8_t humidity;
+    int16_t temperature;
+
+    void onRecord(const Record& record) override;
+};
+
+#endif
@@ -0,0 +1,137 @@
+// ReplayComponents.cpp
+// HAL implementations that play a Recording back
+
+#include "ReplayComponents.h"
+#include <stdlib.h>
+#include <string.h>
+#include "Servo.h"
+#include "Ultrasonic.h"
+
+// HC-SR04: 8-cycle burst before ECHO rises (as in siren-bench)
+#define REPLAY_BURST_DELAY 460      // μs
+
+#define NO_PING ((size_t)-1)
+
+// ============================================
+// SERVO
+// ============================================
+
+ReplayServo::ReplayServo() : angle(SERVO_MIN_ANGLE) {
+}
+
+unsigned long ReplayServo::moveTo(int target) {
+    angle = target;
+    return micros();
+}
+
+// ============================================
+// SENSOR
+// ============================================
+
+ReplaySensor::ReplaySensor(const Recording* rec, const ReplayServo* srv, uint8_t n)
+    : pings(0), unmatched(0), recording(rec), servo(srv), sensor(n), sweepIndex(0),
+      busy(false), readyAt(0), ticks(ECHO_TICKS_NONE), gateTicks(0) {
+    memset(uses, 0, sizeof(uses));
+}
+
+void ReplaySensor::setSweep(size_t index) {
+    sweepIndex = index;
+    memset(uses, 0, sizeof(uses));
+}
+
+// Exact angle first, in turn; otherwise the nearest one
+uint16_t ReplaySensor::lookup(int angle) {
+    const RecordedSweep& sweep = recording->sweep(sweepIndex);
+    size_t matches = 0;
+    size_t nearest = NO_PING;
+    int nearestDistance = 256;
+
+    for (size_t i = sweep.first; i < sweep.first + sweep.count; i++) {
+        const RawPing& ping = recording->ping(i);
+        if (ping.sensor != sensor) {
+            continue;
+        }
+        int distance = abs(ping.angle - angle);
+        if (distance == 0) {
+            matches++;
+        } else if (distance < nearestDistance) {
+            nearestDistance = distance;
+            nearest = i;
+        }
+    }
+
+    if (matches > 0) {
+        size_t wanted = uses[angle & 0xFF]++ % matches;
+        for (size_t i = sweep.first; i < sweep.first + sweep.count; i++) {
+            const RawPing& ping = recording->ping(i);
+            if (ping.sensor == sensor && ping.angle == angle && wanted-- == 0) {
+                return ping.ticks;
+            }
+        }
+    }
+    unmatched++;
+    return nearest != NO_PING ? recording->ping(nearest).ticks : ECHO_TICKS_NONE;
+}
+
+void ReplaySensor::startMeasurement() {
+    pings++;
+    ticks = lookup(servo->position() + sensor * SENSOR_SPACING);
+
+    // RANGE GATE:
+    // Applied to the recorded width. A ping the recording already
+    // cut off stays beyond - its width was never measured.
+    if (gateTicks != 0 && ticks != ECHO_TICKS_NONE && ticks > gateTicks) {
+        ticks = ECHO_TICKS_BEYOND;
+    }
+
+    unsigned long now = micros();
+    if (ticks == ECHO_TICKS_NONE) {
+        readyAt = now + SIM_ECHO_TIMEOUT;
+    } else if (ticks == ECHO_TICKS_BEYOND) {
+        readyAt = now + REPLAY_BURST_DELAY + (gateTicks ? gateTicks / 2 : SIM_ECHO_TIMEOUT);
+    } else {
+        readyAt = now + REPLAY_BURST_DELAY + ticks / 2;
+    }
+    busy = true;
+}
+
+bool ReplaySensor::isReady() {
+    return !busy || micros() >= readyAt;
+}
+
+void ReplaySensor::cancel() {
+    busy = false;
+}
+
+// Same conversion and limits as Ultrasonic::resultMm()
+uint16_t ReplaySensor::resultMm(uint16_t scale) {
+    busy = false;
+    if (ticks == ECHO_TICKS_BEYOND) {
+        return DISTANCE_MM_BEYOND;
+    }
+    if (ticks == ECHO_TICKS_NONE) {
+        return DISTANCE_MM_INVALID;
+    }
+    uint16_t distance = ((uint32_t)ticks * scale + 0x8000) >> 16;
+    if (distance < MIN_DISTANCE * 10 || distance > MAX_DISTANCE * 10) {
+        return DISTANCE_MM_INVALID;
+    }
+    return distance;
+}
+
+uint16_t ReplaySensor::resultTicks() {
+    return ticks;
+}
+
+// Same conversion as Ultrasonic::setRangeGate()
+void ReplaySensor::setRangeGate(uint16_t gateMm, uint16_t scale) {
+    gateTicks = 0;
+    if (gateMm != 0 && scale != 0) {
+        uint32_t gate = ((uint32_t)gateMm << 16) / scale;
+        gateTicks = gate > 0xFFFF ? 0 : gate;
+    }
+}
+
+unsigned long ReplaySensor::nextEvent() {
+    return busy ? readyAt : SIM_NO_EVENT;
+}
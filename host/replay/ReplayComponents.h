@@ -0,0 +1,77 @@
+// ReplayComponents.h
+// HAL implementations that play a Recording back
+//
+// PURPOSE:
+// Stand-ins for the drivers (see Hal.h) that answer each ping from
+// a recording instead of a room, so Scanner - and everything behind
+// it: multi-ping, adaptive sweep, delta and segment output - runs
+// on real sensor data, deterministically and at full CPU speed.
+//
+//   ReplayServo       moves instantly; remembers the angle
+//   ReplaySensor      echo from the recorded sweep at that angle
+//
+// MATCHING:
+// The sensor answers from the recorded sweep the scanner is on
+// (see setSweep()), not from the recording in order. Pings are
+// looked up by sensor and angle, so a scanner configured
+// differently from the unit that recorded - a finer step, more
+// pings per angle - still gets plausible data:
+//   - several pings at one angle are handed out in turn
+//   - an angle the recording never measured takes the nearest
+//     recorded angle (counted in unmatched)
+//
+// TIMING:
+// Echoes are ready after the burst delay plus the recorded width,
+// timeouts after SIM_ECHO_TIMEOUT, as in SimUltrasonic.
+
+#ifndef REPLAY_COMPONENTS_H
+#define REPLAY_COMPONENTS_H
+
+#include <Arduino.h>
+#include "Hal.h"
+#include "Recording.h"
+#include "SimComponents.h"
+
+class ReplayServo : public SweepServo {
+public:
+    ReplayServo();
+    unsigned long moveTo(int angle) override;
+    int position() const { return angle; }
+
+private:
+    int angle;
+};
+
+class ReplaySensor : public RangeSensor {
+public:
+    ReplaySensor(const Recording* recording, const ReplayServo* servo, uint8_t sensor);
+
+    void setSweep(size_t index);        // Answer from this recorded sweep
+
+    void startMeasurement() override;
+    bool isReady() override;
+    void cancel() override;
+    uint16_t resultMm(uint16_t scale) override;
+    uint16_t resultTicks() override;
+    void setRangeGate(uint16_t gateMm, uint16_t scale) override;
+    unsigned long nextEvent();
+
+    // STATISTICS (since construction):
+    unsigned long pings;
+    unsigned long unmatched;        // Answered from a neighbouring angle
+
+private:
+    const Recording* recording;
+    const ReplayServo* servo;
+    uint8_t sensor;
+    size_t sweepIndex;
+    uint8_t uses[256];              // Pings handed out per angle this sweep
+    bool busy;
+    unsigned long readyAt;
+    uint16_t ticks;
+    uint16_t gateTicks;             // 0 = full range
+
+    uint16_t lookup(int angle);
+};
+
+#endif
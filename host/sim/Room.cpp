@@ -0,0 +1,137 @@
+// Room.cpp
+// Ray casting against walls and posts
+
+#include "Room.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+Room::Room() {
+    count = 0;
+}
+
+bool Room::addWall(double x1, double y1, double x2, double y2) {
+    if (count >= ROOM_MAX_SHAPES) {
+        return false;
+    }
+    shapes[count++] = { WALL, x1, y1, x2, y2, 0 };
+    return true;
+}
+
+bool Room::addPost(double x, double y, double radius, double vx, double vy) {
+    if (count >= ROOM_MAX_SHAPES) {
+        return false;
+    }
+    shapes[count++] = { POST, x, y, radius, vx, vy };
+    return true;
+}
+
+bool Room::load(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    count = 0;
+    char line[128];
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        char* comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+
+        char kind[8];
+        double v[5];
+        int fields = sscanf(line, "%7s %lf %lf %lf %lf %lf", kind, &v[0], &v[1], &v[2], &v[3], &v[4]);
+        if (fields <= 0) {
+            continue;               // Blank or comment-only line
+        }
+        if (strcmp(kind, "wall") == 0 && fields == 5) {
+            ok = addWall(v[0], v[1], v[2], v[3]);
+        } else if (strcmp(kind, "post") == 0 && fields == 4) {
+            ok = addPost(v[0], v[1], v[2]);
+        } else if (strcmp(kind, "post") == 0 && fields == 6) {
+            ok = addPost(v[0], v[1], v[2], v[3], v[4]);
+        } else {
+            ok = false;
+        }
+    }
+
+    fclose(file);
+    return ok;
+}
+
+// DEFAULT ROOM:
+// Sensor in the middle of one wall of a 3m × 3m room, with posts
+// at different ranges so adaptive sweep and the delta filter both
+// have something to do.
+void Room::loadDefault() {
+    count = 0;
+    addWall(-1500, 0, -1500, 3000);     // Left
+    addWall(-1500, 3000, 1500, 3000);   // Far
+    addWall(1500, 3000, 1500, 0);       // Right
+    addPost(-600, 900, 150);
+    addPost(300, 1600, 100);
+    addPost(900, 500, 60);
+}
+
+// Distance along the unit vector (dx, dy) to the nearest shape
+double Room::cast(double dx, double dy, double time) const {
+    double nearest = ROOM_NO_HIT;
+
+    for (int i = 0; i < count; i++) {
+        const Shape& s = shapes[i];
+        double t = ROOM_NO_HIT;
+
+        if (s.type == WALL) {
+            // Ray/segment intersection:
+            //   t·(dx,dy) = (x1,y1) + u·(x2-x1, y2-y1),  0 ≤ u ≤ 1
+            double ex = s.c - s.a;
+            double ey = s.d - s.b;
+            double denom = dx * ey - dy * ex;
+            if (fabs(denom) < 1e-12) {
+                continue;           // Parallel
+            }
+            double u = (s.a * dy - s.b * dx) / denom;
+            double hit = (s.a * ey - s.b * ex) / denom;
+            if (u >= 0 && u <= 1 && hit > 0) {
+                t = hit;
+            }
+        } else {
+            // Ray/circle: |t·d - c|² = r²
+            double cx = s.a + s.d * time;
+            double cy = s.b + s.e * time;
+            double proj = cx * dx + cy * dy;
+            double dist2 = cx * cx + cy * cy - proj * proj;
+            double r2 = s.c * s.c;
+            if (proj > 0 && dist2 <= r2) {
+                double hit = proj - sqrt(r2 - dist2);
+                if (hit > 0) {
+                    t = hit;
+                }
+            }
+        }
+
+        if (t > 0 && (nearest < 0 || t < nearest)) {
+            nearest = t;
+        }
+    }
+
+    return nearest;
+}
+
+double Room::range(double angle, double time) const {
+    double nearest = ROOM_NO_HIT;
+
+    for (int i = 0; i < ROOM_BEAM_RAYS; i++) {
+        double offset = ROOM_BEAM_WIDTH * ((double)i / (ROOM_BEAM_RAYS - 1) - 0.5);
+        double rad = (angle + offset) * M_PI / 180.0;
+        double t = cast(cos(rad), sin(rad), time);
+        if (t > 0 && (nearest < 0 || t < nearest)) {
+            nearest = t;
+        }
+    }
+
+    return nearest;
+}
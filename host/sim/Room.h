@@ -0,0 +1,58 @@
+// Room.h
+// Scripted 2D Room Geometry
+//
+// PURPOSE:
+// The world the simulated HC-SR04 looks at. Walls are line
+// segments, posts are circles (table legs, people, bins).
+// Coordinates are millimetres with the sensor at the origin;
+// 0° points along +x, 90° (the middle of the sweep) along +y,
+// matching the servo angle.
+//
+// BEAM:
+// The HC-SR04 hears echoes from a cone about 15° wide, not a
+// single ray. range() casts several rays across the beam and
+// returns the nearest hit - which is why real scans show objects
+// "wider" than they are.
+//
+// FILE FORMAT (one shape per line, '#' starts a comment):
+//   wall x1 y1 x2 y2
+//   post x y radius [vx vy]
+// A post with a velocity (mm/s) starts at x y and moves in a
+// straight line, through anything in its way, for as long as the
+// run lasts.
+
+#ifndef ROOM_H
+#define ROOM_H
+
+#define ROOM_MAX_SHAPES 64
+#define ROOM_BEAM_WIDTH 15.0    // degrees
+#define ROOM_BEAM_RAYS  7
+#define ROOM_NO_HIT     -1.0
+
+class Room {
+public:
+    Room();
+
+    bool addWall(double x1, double y1, double x2, double y2);
+    bool addPost(double x, double y, double radius, double vx = 0, double vy = 0);
+    bool load(const char* path);    // false on I/O or syntax error
+    void loadDefault();             // 3m × 3m room with a few posts
+
+    // Nearest surface within the beam at angle (degrees), in mm,
+    // or ROOM_NO_HIT - at time seconds for moving posts
+    double range(double angle, double time = 0) const;
+
+private:
+    enum ShapeType { WALL, POST };
+    struct Shape {
+        ShapeType type;
+        double a, b, c, d, e;       // wall: x1 y1 x2 y2, post: x y r vx vy
+    };
+
+    Shape shapes[ROOM_MAX_SHAPES];
+    int count;
+
+    double cast(double dx, double dy, double time) const;
+};
+
+#endif
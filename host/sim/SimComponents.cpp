@@ -0,0 +1,288 @@
+// SimComponents.cpp
+// Timing and error models for the simulated hardware
+
+#include "SimComponents.h"
+#include "Servo.h"
+#include "Ultrasonic.h"
+
+// RANDOM NUMBERS:
+// xorshift32 - same sequence on every platform for a given seed,
+// unlike rand()
+static uint32_t rng = 2463534242UL;
+
+static double uniform() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (rng >> 8) * (1.0 / 16777216.0);    // [0, 1)
+}
+
+// Small seeds give xorshift a run of tiny outputs (= dropouts),
+// so spread the bits and discard the first few
+void simRandomSeed(uint32_t seed) {
+    rng = (seed ^ 0x9E3779B9UL) * 2654435761UL;
+    if (rng == 0) {
+        rng = 2463534242UL;
+    }
+    for (int i = 0; i < 8; i++) {
+        uniform();
+    }
+}
+
+// ============================================
+// SERVO
+// ============================================
+
+SimServo::SimServo(const ServoModel& servoModel) {
+    model = servoModel;
+    from = 90;
+    to = 90;
+    moveStart = 0;
+    deadline = 0;
+}
+
+double SimServo::position() {
+    unsigned long now = micros();
+    if (now <= moveStart) {
+        return from;
+    }
+    double travelled = (now - moveStart) / model.microsPerDegree;
+    double distance = to - from;
+    if (travelled >= fabs(distance)) {
+        return to;
+    }
+    return from + (distance > 0 ? travelled : -travelled);
+}
+
+int SimServo::target() {
+    return to;
+}
+
+// PULSE TIMING:
+// Pulses start every SERVO_PERIOD from t = 0. A new width is seen
+// at the next pulse; the servo's control loop then needs deadTime
+// before it starts to turn.
+unsigned long SimServo::moveTo(int angle) {
+    unsigned long now = micros();
+    angle = constrain(angle, 0, 180);
+
+    unsigned long nextPulse = (now / SERVO_PERIOD + 1) * SERVO_PERIOD;
+    unsigned int degrees = abs(angle - to);
+
+    from = position();
+    to = angle;
+    moveStart = nextPulse + model.deadTime;
+
+    // The firmware's settle model (Servo.cpp), not the truth
+    deadline = nextPulse + SERVO_SETTLE_BASE + (unsigned long)degrees * SERVO_SETTLE_PER_DEGREE;
+    return deadline;
+}
+
+unsigned long SimServo::nextEvent() {
+    return deadline > micros() ? deadline : SIM_NO_EVENT;
+}
+
+// ============================================
+// ULTRASONIC SENSOR
+// ============================================
+
+SimUltrasonic::SimUltrasonic(const Room* world, SimServo* srv, const EchoModel& echoModel, int offset) {
+    room = world;
+    servo = srv;
+    model = echoModel;
+    mount = offset;
+    busy = false;
+    readyAt = 0;
+    lineLow = 0;
+    gateMicros = 0;
+    echoTicks = 0;
+    gated = false;
+    latched = false;
+    stuckMark = false;
+    latchEnd = 0;
+    triggers = 0;
+    timeouts = 0;
+    beyond = 0;
+    valid = 0;
+    latchups = 0;
+    skipped = 0;
+    errorSum = 0;
+    truthAtTarget = ROOM_NO_HIT;
+}
+
+// Box-Muller
+double SimUltrasonic::gaussian() {
+    double u1 = uniform();
+    double u2 = uniform();
+    return sqrt(-2.0 * log(u1 + 1e-12)) * cos(2.0 * M_PI * u2);
+}
+
+void SimUltrasonic::startMeasurement() {
+    unsigned long now = micros();
+    triggers++;
+    busy = true;
+
+    if (latched && now >= latchEnd) {
+        latched = false;
+        lineLow = latchEnd;
+    }
+
+    // STUCK LINE (as Ultrasonic::startMeasurement())
+    if (stuckMark) {
+        if (latched) {
+            skipped++;
+            readyAt = now;
+            gated = false;
+            echoTicks = 0;
+            return;
+        }
+        stuckMark = false;
+    }
+
+    // What the sensor sees depends on where it really points
+    double range = room->range(servo->position() + mount, now / 1e6);
+    truthAtTarget = room->range(servo->target() + mount, now / 1e6);
+
+    // ECHO PULSE:
+    // Width is the round trip at the true speed of sound:
+    //   width(μs) = 2 × d(mm) / c(m/s) × 1000
+    bool miss = range < 0 || range > MAX_DISTANCE * 10 || uniform() < model.dropout;
+    double width = SIM_NO_ECHO_PULSE;
+    if (!miss) {
+        width = 2.0 * (range + model.noise * gaussian()) * 1000.0 / model.soundSpeed;
+        if (width < 0) {
+            width = 0;
+        }
+    }
+
+    // A trigger while ECHO is still high waits for it to fall (the
+    // driver only sends it then, see Ultrasonic.h) - a latched line
+    // too, if it is released within the driver's line timeout
+    if (latched && latchEnd <= now + SIM_LINE_TIMEOUT) {
+        latched = false;
+        lineLow = latchEnd;
+    }
+    unsigned long trigger = now > lineLow ? now : lineLow;
+    unsigned long rise = trigger + model.burstDelay;
+    lineLow = rise + (unsigned long)width;
+
+    // Still high at the driver's line timeout: it marks the sensor stuck
+    if (latched) {
+        stuckMark = true;
+        readyAt = now + SIM_LINE_TIMEOUT;
+        gated = false;
+        echoTicks = 0;
+        return;
+    }
+    // Only drawn when enabled, so other runs stay reproducible
+    if (miss && model.stuck > 0 && uniform() < model.stuck) {
+        latched = true;
+        latchEnd = lineLow + SIM_LATCH_RELEASE;
+        latchups++;
+    }
+
+    gated = gateMicros != 0 && width > gateMicros;
+    echoTicks = 0;
+    if (gated) {
+        readyAt = rise + gateMicros;
+    } else if (miss) {
+        readyAt = trigger + SIM_ECHO_TIMEOUT;
+    } else {
+        echoTicks = (uint16_t)(width * 2 + 0.5);   // Timer1 ticks, 0.5μs
+        readyAt = lineLow;
+    }
+
+    // The driver's millis() timeout, counted from the trigger
+    if (readyAt > trigger + SIM_ECHO_TIMEOUT) {
+        readyAt = trigger + SIM_ECHO_TIMEOUT;
+        gated = false;
+        echoTicks = 0;
+    }
+}
+
+// Same conversion as Ultrasonic::setRangeGate()
+void SimUltrasonic::setRangeGate(uint16_t gateMm, uint16_t scale) {
+    gateMicros = 0;
+    if (gateMm != 0 && scale != 0) {
+        uint32_t ticks = ((uint32_t)gateMm << 16) / scale;
+        gateMicros = ticks > 0xFFFF ? 0 : ticks / 2;
+    }
+}
+
+bool SimUltrasonic::isReady() {
+    return !busy || micros() >= readyAt;
+}
+
+void SimUltrasonic::cancel() {
+    busy = false;
+}
+
+// Same conversion and limits as Ultrasonic::resultMm()
+uint16_t SimUltrasonic::resultMm(uint16_t scale) {
+    busy = false;
+
+    if (gated) {
+        beyond++;
+        return DISTANCE_MM_BEYOND;
+    }
+
+    uint16_t distance = DISTANCE_MM_INVALID;
+    if (echoTicks != 0) {
+        distance = ((uint32_t)echoTicks * scale + 0x8000) >> 16;
+        if (distance < MIN_DISTANCE * 10 || distance > MAX_DISTANCE * 10) {
+            distance = DISTANCE_MM_INVALID;
+        }
+    }
+
+    if (distance == DISTANCE_MM_INVALID) {
+        timeouts++;
+    } else {
+        valid++;
+        if (truthAtTarget >= 0) {
+            errorSum += fabs(distance - truthAtTarget);
+        }
+    }
+    return distance;
+}
+
+// Same codes as Ultrasonic::resultTicks(); no statistics, since
+// the scanner asks for both when capturing
+uint16_t SimUltrasonic::resultTicks() {
+    if (gated) {
+        return ECHO_TICKS_BEYOND;
+    }
+    return echoTicks;
+}
+
+unsigned long SimUltrasonic::nextEvent() {
+    return busy ? readyAt : SIM_NO_EVENT;
+}
+
+// ============================================
+// ALERT
+// ============================================
+
+SimAlert::SimAlert() {
+    updates = 0;
+    stops = 0;
+    nearest = DISTANCE_MM_INVALID;
+    soonest = 0xFFFF;               // ARRIVAL_NONE
+}
+
+void SimAlert::updateMm(uint16_t distanceMm) {
+    updates++;
+    if (distanceMm < nearest) {
+        nearest = distanceMm;
+    }
+}
+
+void SimAlert::updateApproach(uint16_t distanceMm, uint16_t arrivalMs) {
+    updateMm(distanceMm);
+    if (arrivalMs < soonest) {
+        soonest = arrivalMs;
+    }
+}
+
+void SimAlert::stop() {
+    stops++;
+}
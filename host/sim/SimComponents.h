@@ -0,0 +1,144 @@
+// SimComponents.h
+// Simulated Servo, Ultrasonic Sensor and Alert
+//
+// PURPOSE:
+// Stand-ins for the firmware drivers behind the Hal.h interfaces.
+// Together with Room they model what the real hardware gets wrong,
+// so the scanner logic can be tuned and benchmarked on a PC:
+//
+//   SimServo       Lags behind the command: motion starts at the
+//                  next 50Hz pulse and slews at a finite speed.
+//                  Returns the firmware's settle-model deadline,
+//                  which may be earlier than the true arrival.
+//
+//   SimUltrasonic  Measures the room at the servo's *actual*
+//                  angle (plus its mounting offset) when triggered. Echo arrives after the
+//                  burst delay plus the round trip; no echo times
+//                  out like the driver does. Adds gaussian noise
+//                  and random dropouts. Honours the range gate,
+//                  and like the real sensor holds ECHO high for
+//                  38ms after a miss, delaying the next trigger.
+//                  Optionally a miss latches ECHO high like a bad
+//                  clone; the driver's stuck-echo handling (see
+//                  Ultrasonic.h) is mirrored. The line is let go
+//                  after SIM_LATCH_RELEASE, standing in for a
+//                  power cycle of the sensor.
+//
+//   SimAlert       Records what the scanner asked for.
+//
+// TIMING:
+// Each component reports its next event (nextEvent()) so the
+// bench can jump the simulated clock instead of ticking through
+// idle time.
+
+#ifndef SIM_COMPONENTS_H
+#define SIM_COMPONENTS_H
+
+#include <Arduino.h>
+#include "Hal.h"
+#include "Room.h"
+
+#define SIM_NO_EVENT 0xFFFFFFFFUL
+
+// The driver gives up ECHO_TIMEOUT_MS (35) after the trigger,
+// checked against millis() - so up to a millisecond later
+#define SIM_ECHO_TIMEOUT 36000      // μs
+
+// ...and ECHO_LINE_TIMEOUT_MS (250) after the start of a wait for
+// a busy line
+#define SIM_LINE_TIMEOUT 251000     // μs
+
+// HC-SR04 ECHO pulse when nothing answers
+#define SIM_NO_ECHO_PULSE 38000     // μs
+
+// How long a latched ECHO line stays high (EchoModel::stuck)
+#define SIM_LATCH_RELEASE 2000000UL // μs
+
+void simRandomSeed(uint32_t seed);  // Noise and dropouts are reproducible
+
+// SG90: datasheet 0.1s/60° unloaded; slower with the sensor on it
+struct ServoModel {
+    unsigned long deadTime;         // μs from pulse to motion
+    double microsPerDegree;
+};
+
+struct EchoModel {
+    unsigned long burstDelay;       // μs from trigger to echo rising edge
+    double soundSpeed;              // m/s (true air, not the firmware's estimate)
+    double noise;                   // mm, standard deviation
+    double dropout;                 // Probability a valid echo is missed
+    double stuck;                   // Probability a miss latches ECHO high
+};
+
+class SimServo : public SweepServo {
+public:
+    SimServo(const ServoModel& model);
+
+    unsigned long moveTo(int angle) override;
+    double position();              // Actual angle now
+    int target();                   // Last commanded angle
+    unsigned long nextEvent();      // Settle deadline, if in the future
+
+private:
+    ServoModel model;
+    double from;                    // Angle when the move began
+    int to;
+    unsigned long moveStart;        // μs, motion begins (after pulse + dead time)
+    unsigned long deadline;
+};
+
+class SimUltrasonic : public RangeSensor {
+public:
+    SimUltrasonic(const Room* room, SimServo* servo, const EchoModel& model, int mount = 0);
+
+    void startMeasurement() override;
+    bool isReady() override;
+    void cancel() override;
+    uint16_t resultMm(uint16_t scale) override;
+    uint16_t resultTicks() override;
+    void setRangeGate(uint16_t gateMm, uint16_t scale) override;
+    unsigned long nextEvent();
+
+    // STATISTICS (since construction):
+    unsigned long triggers;
+    unsigned long timeouts;
+    unsigned long beyond;           // Ended by the range gate
+    unsigned long valid;
+    unsigned long latchups;         // Misses that latched ECHO (model.stuck)
+    unsigned long skipped;          // Ended at once, line still latched
+    double errorSum;                // |reported - truth at commanded angle|, mm
+    double truthAtTarget;           // Last measurement's ideal answer, mm (-1 none)
+
+private:
+    const Room* room;
+    SimServo* servo;
+    EchoModel model;
+    int mount;                      // Degrees from the servo angle
+    bool busy;
+    unsigned long readyAt;
+    unsigned long lineLow;          // When the last ECHO pulse ends
+    unsigned long gateMicros;       // 0 = full range
+    uint16_t echoTicks;             // 0 = timeout
+    bool gated;                     // Last measurement hit the gate
+    bool latched;                   // ECHO held high until reset
+    bool stuckMark;                 // Driver's stuck flag
+    unsigned long latchEnd;         // When a latched line is released
+
+    double gaussian();
+};
+
+class SimAlert : public ProximityAlert {
+public:
+    SimAlert();
+
+    void updateMm(uint16_t distanceMm) override;
+    void updateApproach(uint16_t distanceMm, uint16_t arrivalMs) override;
+    void stop() override;
+
+    unsigned long updates;
+    unsigned long stops;
+    uint16_t nearest;               // Closest distance seen, mm
+    uint16_t soonest;               // Soonest arrival seen, ms (ARRIVAL_NONE)
+};
+
+#endif
@@ -0,0 +1,204 @@
+// SimSerial.cpp
+// SerialPort on a simulated UART
+
+#include <Arduino.h>
+#include "SimSerial.h"
+#include "Timer1.h"
+
+#define TX_MASK (SERIAL_TX_BUFFER_SIZE - 1)
+#define RX_MASK (SERIAL_RX_BUFFER_SIZE - 1)
+
+// 8N1: 10 bits on the wire per byte
+#define BYTE_MICROS(baud) (10000000UL / (baud))
+
+SerialPort serialPort;
+
+static FILE* sink = NULL;
+static unsigned long byteMicros = BYTE_MICROS(SERIAL_BAUD);
+static unsigned long lastService = 0;   // micros() the UART was last advanced
+static unsigned long sent = 0;
+static unsigned long byteCost = 0;      // μs of CPU per byte queued
+static uint8_t rxByte;                  // "UDR0" for rxInterrupt()
+
+void simSerialSetSink(FILE* file) {
+    sink = file;
+}
+
+// RX:
+// Goes through rxInterrupt() so a full buffer drops bytes exactly
+// like the real one.
+void simSerialInject(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        rxByte = data[i];
+        serialPort.rxInterrupt();
+    }
+}
+
+// UART MODEL:
+// One byte leaves the ring every byteMicros of simulated time.
+// Time that passed while the ring was empty is not banked.
+void simSerialService() {
+    unsigned long now = micros();
+    while (now - lastService >= byteMicros) {
+        unsigned long before = sent;
+        serialPort.txInterrupt();
+        if (sent == before) {
+            lastService = now;          // Ring empty: line idle
+            return;
+        }
+        lastService += byteMicros;
+    }
+}
+
+unsigned long simSerialSentBytes() {
+    return sent;
+}
+
+void simSerialSetByteCost(unsigned long micros) {
+    byteCost = micros;
+}
+
+void SerialPort::begin(unsigned long baud) {
+    txHead = txTail = 0;
+    rxHead = rxTail = 0;
+    dropped = stalled = rxDropped = 0;
+    written = false;
+#if ENABLE_PROFILE
+    probeBytes = 0;
+    probing = false;
+#endif
+    byteMicros = BYTE_MICROS(baud);
+    lastService = micros();
+}
+
+uint8_t SerialPort::txFree() {
+    return (uint8_t)(txTail - txHead - 1) & TX_MASK;
+}
+
+uint16_t SerialPort::availableForWrite() {
+    simSerialService();
+    return txFree();
+}
+
+void SerialPort::txInterrupt() {
+    if (txHead == txTail) {
+        return;
+    }
+    uint8_t byte = txBuffer[txTail];
+    txTail = (txTail + 1) & TX_MASK;
+    sent++;
+    if (sink) {
+        fputc(byte, sink);
+    }
+#if ENABLE_PROFILE
+    if (probeBytes != 0 && --probeBytes == 0) {
+        probeEnd = timer1Micros();
+    }
+#endif
+}
+
+void SerialPort::rxInterrupt() {
+    uint8_t next = (rxHead + 1) & RX_MASK;
+    if (next == rxTail) {
+        rxDropped++;
+        return;
+    }
+    rxBuffer[rxHead] = rxByte;
+    rxHead = next;
+}
+
+size_t SerialPort::write(uint8_t byte) {
+    written = true;
+    hostClockAdvance(byteCost);
+    simSerialService();
+
+    // FULL BUFFER:
+    // The scan loop would spin here until the UART made room.
+    if (txFree() == 0) {
+        stalled++;
+        while (txFree() == 0) {
+            hostClockAdvance(byteMicros);
+            simSerialService();
+        }
+    }
+
+    txBuffer[txHead] = byte;
+    txHead = (txHead + 1) & TX_MASK;
+    return 1;
+}
+
+size_t SerialPort::write(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        write(data[i]);
+    }
+    return length;
+}
+
+bool SerialPort::tryWrite(const uint8_t* data, uint8_t length) {
+    if (availableForWrite() < length) {
+        dropped += length;
+        return false;
+    }
+
+    written = true;
+    hostClockAdvance(byteCost * length);
+    for (uint8_t i = 0; i < length; i++) {
+        txBuffer[txHead] = data[i];
+        txHead = (txHead + 1) & TX_MASK;
+    }
+    return true;
+}
+
+void SerialPort::flush() {
+    while (txHead != txTail) {
+        hostClockAdvance(byteMicros);
+        simSerialService();
+    }
+}
+
+int SerialPort::available() {
+    return (uint8_t)(rxHead - rxTail) & RX_MASK;
+}
+
+int SerialPort::read() {
+    if (rxHead == rxTail) {
+        return -1;
+    }
+    uint8_t byte = rxBuffer[rxTail];
+    rxTail = (rxTail + 1) & RX_MASK;
+    return byte;
+}
+
+uint32_t SerialPort::droppedBytes() {
+    return dropped;
+}
+
+uint32_t SerialPort::stalledBytes() {
+    return stalled;
+}
+
+uint32_t SerialPort::rxDroppedBytes() {
+    return rxDropped;
+}
+
+#if ENABLE_PROFILE
+void SerialPort::txProbeStart() {
+    if (probing) {
+        return;
+    }
+    probing = true;
+    probeStart = timer1Micros();
+    probeEnd = probeStart;
+    probeBytes = (uint8_t)(txHead - txTail) & TX_MASK;
+}
+
+bool SerialPort::txProbeDone(uint32_t* micros) {
+    simSerialService();
+    if (!probing || probeBytes != 0) {
+        return false;
+    }
+    probing = false;
+    *micros = probeEnd - probeStart;
+    return true;
+}
+#endif
@@ -0,0 +1,33 @@
+// SimSerial.h
+// Host implementation of SerialPort
+//
+// PURPOSE:
+// The firmware's SerialPort.h is compiled as-is; SimSerial.cpp
+// supplies the member functions. Bytes go through the same TX
+// ring buffer as on the Arduino and leave it at the configured
+// baud rate in simulated time, so backpressure (tryWrite() drops,
+// write() stalls) behaves as it would on the real link.
+//
+// A stalled write() advances the simulated clock by one byte time
+// per byte waited for - the scan loop really would be stuck there.
+//
+// OUTPUT COST:
+// Formatting and queueing is not free on the AVR (print() of a
+// float is tens of μs per digit). simSerialSetByteCost() charges
+// that much simulated CPU time per byte queued; 0 by default.
+//
+// Sent bytes go to the sink, if one is set.
+
+#ifndef SIM_SERIAL_H
+#define SIM_SERIAL_H
+
+#include <stdio.h>
+#include "SerialPort.h"
+
+void simSerialSetSink(FILE* sink);      // NULL = discard
+void simSerialInject(const uint8_t* data, size_t length);  // Host → RX buffer
+void simSerialService();                // Move due bytes out of the ring
+unsigned long simSerialSentBytes();     // Bytes that left the "UART"
+void simSerialSetByteCost(unsigned long micros);    // CPU μs per byte queued
+
+#endif